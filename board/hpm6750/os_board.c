@@ -4,6 +4,7 @@
  * @Change Logs:
  * Date           Author       Notes
  * 2024-02-08     Feijie Luo   Support HPM6750
+ * 2026-10-19     Feijie Luo   Register DLM and non-cacheable heap regions
  * @note: 32bit risc-v mcu
  ***********************/
 
@@ -138,6 +139,13 @@ static void sys_uart_register(void)
 const uint32_t SYSTICK_RELOAD_VAL = (MS_TO_CLOCK_COUNT(1, CONFIG_SYSTICK_CLOCK_FREQUENCY));
 void os_set_usr_heap_head(void* ptr);
 static unsigned char tmp_mem[CONFIG_HEAP_SIZE];
+
+// DLM, single-cycle data memory for hot buffers (DMA needs the system bus alias)
+#define BOARD_FAST_HEAP_SIZE (16384)
+static unsigned char fast_mem[BOARD_FAST_HEAP_SIZE] ATTR_PLACE_AT(".fast_ram") __attribute__((aligned(4)));
+// Non-cacheable AXI SRAM for DMA buffers
+#define BOARD_DMA_HEAP_SIZE (8192)
+static unsigned char dma_mem[BOARD_DMA_HEAP_SIZE] ATTR_PLACE_AT_NONCACHEABLE_BSS __attribute__((aligned(4)));
 void os_board_init(void)
 {
     board_init_clock();
@@ -146,6 +154,8 @@ void os_board_init(void)
 
     // init heap
     os_set_usr_heap_head(tmp_mem);
+    os_heap_region_add(fast_mem, sizeof(fast_mem), OS_MALLOC_CAP_FAST);
+    os_heap_region_add(dma_mem, sizeof(dma_mem), OS_MALLOC_CAP_DMA);
 
     /* systick */
     os_hw_systick_init(SYSTICK_RELOAD_VAL);
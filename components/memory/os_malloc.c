@@ -7,6 +7,23 @@
  * 2023-10-22     Feijie Luo   Fix memory align bug. Fix unsigned int overflow bug.
  * 2023-11-01     Feijie Luo   Add free cmd.
  * 2023-11-02     Feijie Luo   Add NULL judgment in os_free to make os_free safer.
+ * 2026-10-19     Feijie Luo   Add TLSF backend selected by CONFIG_OS_MALLOC_TLSF.
+ * 2026-10-19     Feijie Luo   Compact boundary-tag block headers for first-fit.
+ * 2026-10-19     Feijie Luo   Add heap regions with capabilities and os_malloc_caps.
+ * 2026-10-19     Feijie Luo   Add aligned and cache-line-rounded DMA allocation.
+ * 2026-10-19     Feijie Luo   Add os_realloc and os_krealloc.
+ * 2026-10-19     Feijie Luo   Add heap statistics and per-task accounting, fix kfree cmd size.
+ * 2026-10-19     Feijie Luo   Make the kernel heap interrupt-safe, add os_malloc_isr.
+ * 2026-10-19     Feijie Luo   Add per-task caches for os_malloc_safe.
+ * 2026-10-19     Feijie Luo   Add debug heap with tail canaries and a verifier task.
+ * 2026-10-19     Feijie Luo   Take heap statistics under the heap's own lock.
+ * 2026-10-19     Feijie Luo   Do not charge a task for blocks of an exited task with the same id.
+ * 2026-10-19     Feijie Luo   Charge blocks allocated in interrupts to no task.
+ * 2026-10-19     Feijie Luo   Mask all interrupts around the kernel heap.
+ * 2026-10-19     Feijie Luo   Flush the task cache and retry when os_malloc_safe fails, count cache hits.
+ * 2026-10-19     Feijie Luo   Fix list_add argument order in the first-fit free list.
+ * 2026-10-19     Feijie Luo   Restart the verifier walk only when its block is merged away.
+ * 2026-10-19     Feijie Luo   Verify under the heap's lock, seal canaries last, print reports unlocked.
  * @note:
  ***********************/
 
@@ -17,13 +34,17 @@
 #include "../../os_list.h"
 #include "../../os_service.h"
 #include "../../os_mutex.h"
+#include "../../os_core.h"
+#include "../../os_sched.h"
+#include "../../os_sys.h"
+#include "../../os_tick.h"
 #include "../lib/os_string.h"
 #include "os_malloc.h"
+#include "os_mempool.h"
+#include "os_tlsf.h"
 
-#define HEAP_MEM_MAGIC (0x6870) // magic number
-
-static LIST_HEAD(heap_list_head);
-static LIST_HEAD(kernel_heap_list_head);
+static OS_MALLOC_HANDLE _usr_heap = 0;
+static OS_MALLOC_HANDLE _kernel_heap = 0;
 static struct os_mutex _usr_memery_op_mutex;
 
 struct heap_structure {
@@ -31,104 +52,1063 @@ struct heap_structure {
     unsigned int heap_size;
 };
 
-static volatile struct heap_structure heap = {.heap_head = NULL, .heap_size = 0};
-static volatile struct heap_structure kernel_heap = {.heap_head = NULL, .heap_size = 0};
+static volatile struct heap_structure heap = {.heap_head = NULL, .heap_size = 0};
+static volatile struct heap_structure kernel_heap = {.heap_head = NULL, .heap_size = 0};
+
+#if (CONFIG_OS_CACHE_LINE_SIZE & (CONFIG_OS_CACHE_LINE_SIZE - 1)) || (CONFIG_OS_CACHE_LINE_SIZE < 4)
+#error "CONFIG_OS_CACHE_LINE_SIZE must be a power of 2 and at least 4"
+#endif
+
+#if CONFIG_OS_MALLOC_CACHE_NUM > 0
+#if (CONFIG_OS_MALLOC_CACHE_NUM > 255) || (CONFIG_OS_MALLOC_CACHE_BATCH < 1) || \
+    (CONFIG_OS_MALLOC_CACHE_BATCH > CONFIG_OS_MALLOC_CACHE_NUM)
+#error "CONFIG_OS_MALLOC_CACHE_BATCH must be in [1, CONFIG_OS_MALLOC_CACHE_NUM] and CONFIG_OS_MALLOC_CACHE_NUM at most 255"
+#endif
+#endif
+
+#ifndef CONFIG_HEAP_CAPS
+#define CONFIG_HEAP_CAPS (OS_MALLOC_CAP_DEFAULT)
+#endif
+
+struct heap_region {
+    OS_MALLOC_HANDLE _handle;
+    unsigned char *_start;
+    unsigned char *_end;
+    unsigned int _caps;
+};
+
+// Region 0 is the user heap, it is filled in by os_memory_init().
+static struct heap_region _heap_regions[CONFIG_OS_HEAP_REGION_NUM];
+static unsigned int _heap_region_num = 1;
+
+/**
+ * Counters placed by os_malloc_keep() just below the backend. They are kept
+ * up to date on every allocation and free, so reading them never walks the heap.
+ */
+struct heap_counters {
+    unsigned int _total; // bytes of the pool, block headers included
+    unsigned int _used; // bytes held by live blocks, block headers included
+    unsigned int _peak;
+    unsigned int _alloc_num;
+    unsigned int _free_num; // first-fit only, TLSF counts its own free blocks
+    volatile os_base_t _hist[OS_MALLOC_HIST_NUM]; // also bumped by lock-free cache hits
+#ifdef CONFIG_OS_MALLOC_DEBUG
+    unsigned char *_end; // end of the memory handed to os_malloc_keep()
+    unsigned int _corrupt_num;
+    // The last block checked by os_malloc_verify(), NULL to start over.
+    void *_verify_cursor;
+#endif
+};
+
+#define __os_heap_counters(_handle) ((struct heap_counters *)(_handle) - 1)
+
+#if CONFIG_OS_MALLOC_ISR_POOL_NUM > 0
+
+// Lock-free pools for os_malloc_isr(), one per size class.
+#define OS_MALLOC_ISR_CLASS_NUM (4)
+
+static unsigned int _isr_pool_buf_32[OS_MEMPOOL_BUF_SIZE(32, CONFIG_OS_MALLOC_ISR_POOL_NUM) / sizeof(unsigned int)];
+static unsigned int _isr_pool_buf_64[OS_MEMPOOL_BUF_SIZE(64, CONFIG_OS_MALLOC_ISR_POOL_NUM) / sizeof(unsigned int)];
+static unsigned int _isr_pool_buf_128[OS_MEMPOOL_BUF_SIZE(128, CONFIG_OS_MALLOC_ISR_POOL_NUM) / sizeof(unsigned int)];
+static unsigned int _isr_pool_buf_256[OS_MEMPOOL_BUF_SIZE(256, CONFIG_OS_MALLOC_ISR_POOL_NUM) / sizeof(unsigned int)];
+
+static struct os_mempool _isr_pools[OS_MALLOC_ISR_CLASS_NUM] = {
+    OS_MEMPOOL_INIT(_isr_pool_buf_32, 32, CONFIG_OS_MALLOC_ISR_POOL_NUM),
+    OS_MEMPOOL_INIT(_isr_pool_buf_64, 64, CONFIG_OS_MALLOC_ISR_POOL_NUM),
+    OS_MEMPOOL_INIT(_isr_pool_buf_128, 128, CONFIG_OS_MALLOC_ISR_POOL_NUM),
+    OS_MEMPOOL_INIT(_isr_pool_buf_256, 256, CONFIG_OS_MALLOC_ISR_POOL_NUM),
+};
+
+#endif
+
+/**
+ * First-fit block layout. A used block only pays for the size word; a free
+ * block also holds its free-list node and repeats its size in the last word
+ * so the next block can find it when coalescing.
+ */
+struct small_memory_header {
+    unsigned int _size; // bytes including this word, low bits hold HEAP_BLOCK_* flags
+    struct list_head _nd; // only valid in free blocks
+};
+
+#define HEAP_BLOCK_USED      (1U << 0)
+#define HEAP_BLOCK_PREV_USED (1U << 1)
+#define HEAP_BLOCK_FLAGS     (HEAP_BLOCK_USED | HEAP_BLOCK_PREV_USED)
+#define HEAP_BLOCK_HEAD_SIZE (sizeof(unsigned int))
+#define HEAP_BLOCK_MIN_SIZE  (sizeof(struct small_memory_header) + sizeof(unsigned int))
+
+/**
+ * Called by os_board_init(), the size of heap must be CONFIG_HEAP_SIZE
+ *
+ * @param[in/out] ptr      The head of the heap.
+ *
+ * @return        void
+ */
+void os_set_usr_heap_head(void* ptr)
+{
+    heap.heap_head = ptr;
+    heap.heap_size = CONFIG_HEAP_SIZE;
+}
+
+void os_set_kernel_heap_head(void* ptr)
+{
+    kernel_heap.heap_head = ptr;
+    kernel_heap.heap_size = CONFIG_KERNEL_HEAP_SIZE;
+}
+
+/**
+ * Initialize the memory manage subsystem.
+ *
+ * In EPoseRTOS, it is called in os_sys_init() function
+ */
+void os_memory_init(void)
+{
+    os_mutex_init(&_usr_memery_op_mutex, OS_MUTEX_RECURSIVE);
+    OS_ASSERT(heap.heap_head != NULL);
+    _usr_heap = os_malloc_keep(heap.heap_head, heap.heap_size);
+    OS_ASSERT(_usr_heap != 0);
+    _heap_regions[0]._handle = _usr_heap;
+    _heap_regions[0]._start = (unsigned char *)heap.heap_head;
+    _heap_regions[0]._end = (unsigned char *)heap.heap_head + heap.heap_size;
+    _heap_regions[0]._caps = CONFIG_HEAP_CAPS;
+
+    OS_ASSERT(kernel_heap.heap_head != NULL);
+    _kernel_heap = os_malloc_keep(kernel_heap.heap_head, kernel_heap.heap_size);
+    OS_ASSERT(_kernel_heap != 0);
+}
+
+#ifdef CONFIG_OS_MALLOC_TLSF
+
+/**
+ * Allocate memory from a TLSF heap in O(1).
+ *
+ * @param[in] _handle The heap handle returned by os_malloc_keep(...).
+ * @param[in] _size   The size of the memory block to be allocated.
+ *
+ * @return A pointer to the allocated memory block.
+ */
+os_private inline void *__os_malloc_base(OS_MALLOC_HANDLE _handle,
+                                         unsigned int _size)
+{
+    return os_tlsf_malloc((OS_TLSF_HANDLE)_handle, _size);
+}
+
+os_private inline void __os_free_base(OS_MALLOC_HANDLE _handle,
+                                      void *_ptr)
+{
+    os_tlsf_free((OS_TLSF_HANDLE)_handle, _ptr);
+}
+
+os_private inline void *__os_malloc_aligned_base(OS_MALLOC_HANDLE _handle,
+                                                 unsigned int _size, unsigned int _align)
+{
+    return os_tlsf_malloc_aligned((OS_TLSF_HANDLE)_handle, _size, _align);
+}
+
+os_private inline bool __os_heap_resize(OS_MALLOC_HANDLE _handle, void *_ptr, unsigned int _size)
+{
+    return OS_HANDLE_SUCCESS == os_tlsf_resize((OS_TLSF_HANDLE)_handle, _ptr, _size);
+}
+
+os_private inline unsigned int __os_heap_usable_size(void *_ptr)
+{
+    return os_tlsf_block_size(_ptr);
+}
+
+os_private inline OS_MALLOC_HANDLE __os_heap_create(void *_m_head, unsigned int _size)
+{
+    return (OS_MALLOC_HANDLE)os_tlsf_create(_m_head, _size);
+}
+
+/**
+ * The number of free blocks and the size of the largest one, headers included.
+ */
+os_private inline void __os_heap_free_info(OS_MALLOC_HANDLE _handle, unsigned int *_free_num, unsigned int *_largest)
+{
+    os_tlsf_free_info((OS_TLSF_HANDLE)_handle, _free_num, _largest);
+    if (*_largest != 0)
+        *_largest += HEAP_BLOCK_HEAD_SIZE;
+}
+
+#ifdef CONFIG_OS_MALLOC_DEBUG
+
+os_private inline bool __os_heap_block_is_used(void *_ptr)
+{
+    return !os_tlsf_block_is_free(_ptr);
+}
+
+os_private inline bool __os_heap_block_check(OS_MALLOC_HANDLE _handle, void *_ptr)
+{
+    return os_tlsf_block_check((OS_TLSF_HANDLE)_handle, _ptr);
+}
+
+os_private inline void *__os_heap_block_walk(OS_MALLOC_HANDLE _handle, void *_ptr)
+{
+    return os_tlsf_block_walk((OS_TLSF_HANDLE)_handle, _ptr);
+}
+
+#endif
+
+#else
+
+os_private inline unsigned int __os_heap_block_size(const struct small_memory_header *smh)
+{
+    return smh->_size & ~HEAP_BLOCK_FLAGS;
+}
+
+os_private inline struct small_memory_header *__os_heap_block_next(const struct small_memory_header *smh)
+{
+    return (struct small_memory_header *)((unsigned char *)smh + __os_heap_block_size(smh));
+}
+
+/**
+ * Mark a block free: write its footer and tell the next block.
+ */
+os_private inline void __os_heap_block_set_free(struct small_memory_header *smh, unsigned int _size)
+{
+    smh->_size = _size | (smh->_size & HEAP_BLOCK_PREV_USED);
+    *(unsigned int *)((unsigned char *)smh + _size - sizeof(unsigned int)) = _size;
+    __os_heap_block_next(smh)->_size &= ~HEAP_BLOCK_PREV_USED;
+}
+
+os_private inline void __os_heap_free_list_add(OS_MALLOC_HANDLE _handle, struct small_memory_header *smh)
+{
+    list_add((struct list_head *)_handle, &(smh->_nd));
+    __os_heap_counters(_handle)->_free_num++;
+}
+
+os_private inline void __os_heap_free_list_del(OS_MALLOC_HANDLE _handle, struct small_memory_header *smh)
+{
+    list_del(&(smh->_nd));
+    __os_heap_counters(_handle)->_free_num--;
+}
+
+/**
+ * Round a request up to a multiple of 4 and add the size word.
+ *
+ * @return 0 if the request can never be satisfied.
+ */
+os_private inline unsigned int __os_heap_adjust_size(unsigned int _size)
+{
+    if (_size == 0 || _size > ~0U - HEAP_BLOCK_MIN_SIZE)
+        return 0;
+    _size = ((_size + 3) & ~3U) + HEAP_BLOCK_HEAD_SIZE;
+    return _size < HEAP_BLOCK_MIN_SIZE ? HEAP_BLOCK_MIN_SIZE : _size;
+}
+
+/**
+ * Mark a free block, already taken off the free list, used. The tail beyond
+ * _size goes back to the free list.
+ */
+os_private void *__os_heap_block_take(OS_MALLOC_HANDLE _handle,
+                                      struct small_memory_header *smh, unsigned int _size)
+{
+    unsigned int _block_size = __os_heap_block_size(smh);
+
+    if (_block_size - _size >= HEAP_BLOCK_MIN_SIZE) {
+        // Split, the tail stays free.
+        struct small_memory_header *next_smh = (struct small_memory_header *)((unsigned char *)smh + _size);
+        next_smh->_size = HEAP_BLOCK_PREV_USED;
+        __os_heap_block_set_free(next_smh, _block_size - _size);
+        __os_heap_free_list_add(_handle, next_smh);
+        _block_size = _size;
+    } else {
+        __os_heap_block_next(smh)->_size |= HEAP_BLOCK_PREV_USED;
+    }
+    smh->_size = _block_size | (smh->_size & HEAP_BLOCK_PREV_USED) | HEAP_BLOCK_USED;
+    return ((void *)((unsigned char *)smh + HEAP_BLOCK_HEAD_SIZE));
+}
+
+/**
+ * Allocate memory from the free list (mounted with unallocated blocks only).
+ *
+ * @param[in/out] _handle         The head of the free list.
+ * @param[in]     _size(byte)     The size of the memory block to be allocated.
+ *
+ * @return                A pointer to the allocated memory block.
+ */
+os_private void *__os_malloc_base(OS_MALLOC_HANDLE _handle,
+                                   unsigned int _size)
+{
+    struct list_head *_free_list_head = (struct list_head *)_handle;
+    struct list_head *_current_node = NULL;
+
+    _size = __os_heap_adjust_size(_size);
+    if (_size == 0)
+        return NULL;
+
+    list_for_each(_current_node, _free_list_head)
+    {
+        struct small_memory_header *smh = os_list_entry(_current_node, struct small_memory_header, _nd);
+        if (__os_heap_block_size(smh) < _size)
+            continue;
+        __os_heap_free_list_del(_handle, smh);
+        return __os_heap_block_take(_handle, smh, _size);
+    }
+    return NULL;
+}
+
+/**
+ * Allocate memory whose address is a multiple of _align, the leading gap of
+ * the chosen free block is split off and stays free.
+ */
+os_private void *__os_malloc_aligned_base(OS_MALLOC_HANDLE _handle,
+                                          unsigned int _size, unsigned int _align)
+{
+    struct list_head *_free_list_head = (struct list_head *)_handle;
+    struct list_head *_current_node = NULL;
+
+    if (_align == 0 || (_align & (_align - 1)))
+        return NULL;
+    if (_align <= 4)
+        return __os_malloc_base(_handle, _size);
+    _size = __os_heap_adjust_size(_size);
+    if (_size == 0)
+        return NULL;
+
+    list_for_each(_current_node, _free_list_head)
+    {
+        struct small_memory_header *smh = os_list_entry(_current_node, struct small_memory_header, _nd);
+        unsigned int _payload = (unsigned int)smh + HEAP_BLOCK_HEAD_SIZE;
+        unsigned int _gap = ((_payload + _align - 1) & ~(_align - 1)) - _payload;
+        // A leading gap must be able to hold a free block.
+        if (_gap != 0 && _gap < HEAP_BLOCK_MIN_SIZE)
+            _gap = ((_payload + HEAP_BLOCK_MIN_SIZE + _align - 1) & ~(_align - 1)) - _payload;
+        unsigned int _block_size = __os_heap_block_size(smh);
+        if (_block_size < _size || _block_size - _size < _gap)
+            continue;
+        __os_heap_free_list_del(_handle, smh);
+        if (_gap != 0) {
+            struct small_memory_header *aligned_smh = (struct small_memory_header *)((unsigned char *)smh + _gap);
+            aligned_smh->_size = _block_size - _gap;
+            __os_heap_block_set_free(smh, _gap);
+            __os_heap_free_list_add(_handle, smh);
+            smh = aligned_smh;
+        }
+        return __os_heap_block_take(_handle, smh, _size);
+    }
+    return NULL;
+}
+
+os_private void __os_free_base(OS_MALLOC_HANDLE _handle,
+                                void *_ptr)
+{
+    if (_ptr == NULL)
+        return;
+
+    struct small_memory_header *smh = (struct small_memory_header *)((unsigned char *)_ptr - HEAP_BLOCK_HEAD_SIZE);
+    OS_ASSERT(smh->_size & HEAP_BLOCK_USED);
+    unsigned int _size = __os_heap_block_size(smh);
+
+    // Merge the next block through its header.
+    struct small_memory_header *smh_next = __os_heap_block_next(smh);
+    if (!(smh_next->_size & HEAP_BLOCK_USED)) {
+        __os_heap_free_list_del(_handle, smh_next);
+        _size += __os_heap_block_size(smh_next);
+    }
+    // Merge the previous block through its footer.
+    if (!(smh->_size & HEAP_BLOCK_PREV_USED)) {
+        unsigned int _prev_size = *(unsigned int *)((unsigned char *)smh - sizeof(unsigned int));
+        smh = (struct small_memory_header *)((unsigned char *)smh - _prev_size);
+        __os_heap_free_list_del(_handle, smh);
+        _size += _prev_size;
+    }
+    smh->_size &= ~HEAP_BLOCK_USED;
+    __os_heap_block_set_free(smh, _size);
+    __os_heap_free_list_add(_handle, smh);
+}
+
+/**
+ * Resize an allocated block in place, growing into the next block when it is
+ * free and returning any excess to the free list.
+ *
+ * @return false if the block cannot grow in place, it is left unchanged.
+ */
+os_private bool __os_heap_resize(OS_MALLOC_HANDLE _handle, void *_ptr, unsigned int _size)
+{
+    struct small_memory_header *smh = (struct small_memory_header *)((unsigned char *)_ptr - HEAP_BLOCK_HEAD_SIZE);
+    unsigned int _block_size = __os_heap_block_size(smh);
+    struct small_memory_header *smh_next = __os_heap_block_next(smh);
+
+    _size = __os_heap_adjust_size(_size);
+    if (_size == 0)
+        return false;
+
+    if (_size > _block_size) {
+        if ((smh_next->_size & HEAP_BLOCK_USED) ||
+            _block_size + __os_heap_block_size(smh_next) < _size)
+            return false;
+        __os_heap_free_list_del(_handle, smh_next);
+        _block_size += __os_heap_block_size(smh_next);
+        smh->_size = _block_size | (smh->_size & HEAP_BLOCK_FLAGS);
+        smh_next = __os_heap_block_next(smh);
+        smh_next->_size |= HEAP_BLOCK_PREV_USED;
+    }
+
+    if (_block_size - _size >= HEAP_BLOCK_MIN_SIZE) {
+        // Give the excess back, merged with a free successor.
+        struct small_memory_header *tail_smh = (struct small_memory_header *)((unsigned char *)smh + _size);
+        unsigned int _tail_size = _block_size - _size;
+        if (!(smh_next->_size & HEAP_BLOCK_USED)) {
+            __os_heap_free_list_del(_handle, smh_next);
+            _tail_size += __os_heap_block_size(smh_next);
+        }
+        smh->_size = _size | (smh->_size & HEAP_BLOCK_FLAGS);
+        tail_smh->_size = HEAP_BLOCK_PREV_USED;
+        __os_heap_block_set_free(tail_smh, _tail_size);
+        __os_heap_free_list_add(_handle, tail_smh);
+    }
+    return true;
+}
+
+os_private inline unsigned int __os_heap_usable_size(void *_ptr)
+{
+    struct small_memory_header *smh = (struct small_memory_header *)((unsigned char *)_ptr - HEAP_BLOCK_HEAD_SIZE);
+    return __os_heap_block_size(smh) - HEAP_BLOCK_HEAD_SIZE;
+}
+
+/**
+ * Mount the free list head and one free block ended by a used zero-size
+ * sentinel on the memory block.
+ */
+os_private OS_MALLOC_HANDLE __os_heap_create(void *_m_head, unsigned int _size)
+{
+    struct list_head *keep_head = (struct list_head *)_m_head;
+    list_head_init(keep_head);
+
+    struct small_memory_header *_m =
+        (struct small_memory_header *)((unsigned int)_m_head + sizeof(struct list_head));
+    unsigned int _block_size = (_size - sizeof(struct list_head) - HEAP_BLOCK_HEAD_SIZE) & ~3U;
+    struct small_memory_header *_tail = (struct small_memory_header *)((unsigned char *)_m + _block_size);
+    _tail->_size = HEAP_BLOCK_USED;
+    _m->_size = HEAP_BLOCK_PREV_USED;
+    __os_heap_block_set_free(_m, _block_size);
+    __os_heap_free_list_add((OS_MALLOC_HANDLE)keep_head, _m);
+
+    return (OS_MALLOC_HANDLE)keep_head;
+}
+
+/**
+ * The number of free blocks and the size of the largest one, headers
+ * included. The count is kept by the free list, the largest block is found
+ * by walking it.
+ */
+os_private void __os_heap_free_info(OS_MALLOC_HANDLE _handle, unsigned int *_free_num, unsigned int *_largest)
+{
+    struct list_head *_current_node = NULL;
+    unsigned int _max = 0;
+
+    list_for_each(_current_node, (struct list_head *)_handle)
+    {
+        struct small_memory_header *smh = os_list_entry(_current_node, struct small_memory_header, _nd);
+        if (__os_heap_block_size(smh) > _max)
+            _max = __os_heap_block_size(smh);
+    }
+    *_free_num = __os_heap_counters(_handle)->_free_num;
+    *_largest = _max;
+}
+
+
+#ifdef CONFIG_OS_MALLOC_DEBUG
+
+os_private inline bool __os_heap_block_is_used(void *_ptr)
+{
+    return (((struct small_memory_header *)((unsigned char *)_ptr - HEAP_BLOCK_HEAD_SIZE))->_size & HEAP_BLOCK_USED) != 0;
+}
+
+os_private inline bool __os_heap_addr_ok(OS_MALLOC_HANDLE _handle, const void *_p)
+{
+    return (unsigned char *)_p >= (unsigned char *)_handle &&
+           (unsigned char *)_p < __os_heap_counters(_handle)->_end &&
+           0 == ((unsigned int)_p & 3);
+}
+
+/**
+ * Check the boundary tags of a block without trusting them: it must lie in
+ * the heap, and it and its next block must agree on whether it is free. A
+ * free block must also have a matching footer, used neighbours and sound
+ * free-list links.
+ */
+os_private bool __os_heap_block_check(OS_MALLOC_HANDLE _handle, void *_ptr)
+{
+    unsigned char *_first = (unsigned char *)_handle + sizeof(struct list_head) + HEAP_BLOCK_HEAD_SIZE;
+    struct small_memory_header *smh = (struct small_memory_header *)((unsigned char *)_ptr - HEAP_BLOCK_HEAD_SIZE);
+
+    if ((unsigned char *)_ptr < _first || !__os_heap_addr_ok(_handle, _ptr))
+        return false;
+    unsigned int _size = __os_heap_block_size(smh);
+    // Leave room for the next header.
+    if (_size < HEAP_BLOCK_MIN_SIZE ||
+        _size > (unsigned int)(__os_heap_counters(_handle)->_end - (unsigned char *)smh) - HEAP_BLOCK_HEAD_SIZE)
+        return false;
+    struct small_memory_header *smh_next = __os_heap_block_next(smh);
+    if (smh->_size & HEAP_BLOCK_USED)
+        return (smh_next->_size & HEAP_BLOCK_PREV_USED) != 0;
+    return *(unsigned int *)((unsigned char *)smh + _size - sizeof(unsigned int)) == _size &&
+           !(smh_next->_size & HEAP_BLOCK_PREV_USED) &&
+           (smh_next->_size & HEAP_BLOCK_USED) &&
+           (smh->_size & HEAP_BLOCK_PREV_USED) &&
+           __os_heap_addr_ok(_handle, smh->_nd.next) &&
+           __os_heap_addr_ok(_handle, smh->_nd.prev) &&
+           smh->_nd.next->prev == &(smh->_nd) &&
+           smh->_nd.prev->next == &(smh->_nd);
+}
+
+/**
+ * Step a walk over the heap in address order, NULL starts it. The block
+ * passed in should have passed __os_heap_block_check().
+ *
+ * @return The payload of the next block, NULL at the sentinel.
+ */
+os_private void *__os_heap_block_walk(OS_MALLOC_HANDLE _handle, void *_ptr)
+{
+    struct small_memory_header *smh;
+
+    if (_ptr == NULL)
+        smh = (struct small_memory_header *)((unsigned char *)_handle + sizeof(struct list_head));
+    else
+        smh = __os_heap_block_next((struct small_memory_header *)((unsigned char *)_ptr - HEAP_BLOCK_HEAD_SIZE));
+    if (__os_heap_block_size(smh) == 0)
+        return NULL;
+    return (void *)((unsigned char *)smh + HEAP_BLOCK_HEAD_SIZE);
+}
+
+#endif
+#endif
+
+/**
+ * Find the heap a block was allocated from, falling back to the user heap.
+ */
+os_private OS_MALLOC_HANDLE __os_heap_of(const void *_ptr)
+{
+    const unsigned char *_p = (const unsigned char *)_ptr;
+    for (unsigned int _i = 1; _i < _heap_region_num; ++_i) {
+        if (_p >= _heap_regions[_i]._start && _p < _heap_regions[_i]._end)
+            return _heap_regions[_i]._handle;
+    }
+    return _usr_heap;
+}
+
+#if defined(CONFIG_OS_MALLOC_TASK_STATS) || defined(CONFIG_OS_MALLOC_DEBUG)
+
+/**
+ * Kept in the last words of each block, behind the space the caller asked for.
+ */
+struct heap_trailer {
+#ifdef CONFIG_OS_MALLOC_DEBUG
+    unsigned int _canary;
+    unsigned int _size; // the size the caller asked for
+    unsigned int _pc; // return address of the allocating call
+#endif
+    unsigned int _owner; // id of the allocating task, with its generation above HEAP_OWNER_ID_BITS
+};
+
+#define HEAP_TRAILER_SIZE  (sizeof(struct heap_trailer))
+#define HEAP_OWNER_NONE    (~0U)
+#define HEAP_OWNER_ID_BITS (8)
+#define HEAP_OWNER_ID_MASK ((1U << HEAP_OWNER_ID_BITS) - 1)
+
+#if OS_TASK_MAX_ID >= (1 << HEAP_OWNER_ID_BITS) - 1
+#error "OS_TASK_MAX_ID must be less than 255 to record block owners"
+#endif
+
+os_private inline struct heap_trailer *__os_heap_trailer(void *_ptr)
+{
+    return (struct heap_trailer *)((unsigned char *)_ptr + __os_heap_usable_size(_ptr) - HEAP_TRAILER_SIZE);
+}
+
+#else
+
+#define HEAP_TRAILER_SIZE (0)
+
+#endif
+
+#ifdef CONFIG_OS_MALLOC_DEBUG
+
+#define HEAP_DEBUG_CANARY (0x5AFEC0DEU)
+// A block parked in a task cache carries this canary instead.
+#define HEAP_DEBUG_CACHED (0xCAC4EDU)
+#define HEAP_DEBUG_FILL   (0xA5U)
+#define __OS_HEAP_CALLER  ((unsigned int)__builtin_return_address(0))
+// Keep the compiler from sinking a canary store below the stores it seals.
+#define __OS_HEAP_DEBUG_BARRIER __asm__ volatile ("" : : : "memory");
+
+/**
+ * Fill the slack between the data and the trailer so that short overruns
+ * are caught too, then seal the block with a canary bound to its address.
+ * The canary goes last: cache hits stamp blocks without the heap lock, and
+ * the verifier may look at the block between any two of these stores.
+ */
+os_private void __os_heap_debug_stamp(void *_ptr, unsigned int _size, unsigned int _pc)
+{
+    struct heap_trailer *_t = __os_heap_trailer(_ptr);
+
+    for (unsigned char *_p = (unsigned char *)_ptr + _size; _p < (unsigned char *)_t; ++_p)
+        *_p = HEAP_DEBUG_FILL;
+    _t->_size = _size;
+    _t->_pc = _pc;
+    __OS_HEAP_DEBUG_BARRIER
+    _t->_canary = HEAP_DEBUG_CANARY ^ (unsigned int)_ptr;
+}
+
+/**
+ * The first report not printed yet. Reports are made with a heap locked,
+ * possibly with interrupts masked, so they are printed later by
+ * __os_heap_debug_flush() once the lock is released.
+ */
+static struct heap_debug_report {
+    void *_ptr;
+    const char *_what;
+    unsigned int _size;
+    unsigned int _owner;
+    unsigned int _pc;
+    bool _has_trailer;
+    unsigned int _num;
+} _heap_debug_pending;
+
+os_private void __os_heap_debug_report(OS_MALLOC_HANDLE _handle, void *_ptr,
+                                       struct heap_trailer *_t, const char *_what)
+{
+    OS_ENTER_CRITICAL
+    __os_heap_counters(_handle)->_corrupt_num++;
+    if (_heap_debug_pending._num++ == 0) {
+        _heap_debug_pending._ptr = _ptr;
+        _heap_debug_pending._what = _what;
+        _heap_debug_pending._has_trailer = (_t != NULL);
+        if (_t != NULL) {
+            _heap_debug_pending._size = _t->_size;
+            _heap_debug_pending._owner = _t->_owner;
+            _heap_debug_pending._pc = _t->_pc;
+        }
+    }
+    OS_EXIT_CRITICAL
+}
+
+/**
+ * Print the pending report, if any. Called with no heap locked.
+ */
+os_private void __os_heap_debug_flush(void)
+{
+    OS_ENTER_CRITICAL
+    struct heap_debug_report _r = _heap_debug_pending;
+    _heap_debug_pending._num = 0;
+    OS_EXIT_CRITICAL
+
+    if (_r._num == 0)
+        return;
+    if (!_r._has_trailer)
+        os_printk(":heap %s 0x%x\r\n", _r._what, (unsigned int)_r._ptr);
+    else
+        os_printk(":heap %s 0x%x size %d task %d pc 0x%x\r\n",
+                  _r._what, (unsigned int)_r._ptr, _r._size,
+                  (_r._owner == HEAP_OWNER_NONE) ? -1 : (int)(_r._owner & HEAP_OWNER_ID_MASK), _r._pc);
+    if (_r._num > 1)
+        os_printk(":heap and %d more\r\n", _r._num - 1);
+}
+
+/**
+ * Validate a block handed back by the caller, or visited by the verifier:
+ * it must be an allocated block of this heap with its canary and slack
+ * intact. A bad block is reported and must not be touched any further.
+ *
+ * @param[in] _cached_ok A block parked in a task cache passes, the verifier
+ *                       sees those; it is a double free otherwise.
+ */
+os_private bool __os_heap_debug_check(OS_MALLOC_HANDLE _handle, void *_ptr, bool _cached_ok)
+{
+    if (!__os_heap_block_check(_handle, _ptr) || !__os_heap_block_is_used(_ptr)) {
+        __os_heap_debug_report(_handle, _ptr, NULL, "bad block");
+        return false;
+    }
+    struct heap_trailer *_t = __os_heap_trailer(_ptr);
+    if (_t->_canary == (HEAP_DEBUG_CACHED ^ (unsigned int)_ptr)) {
+        if (!_cached_ok)
+            __os_heap_debug_report(_handle, _ptr, _t, "double free");
+        return _cached_ok;
+    }
+    if (_t->_canary != (HEAP_DEBUG_CANARY ^ (unsigned int)_ptr) ||
+        _t->_size > __os_heap_usable_size(_ptr) - HEAP_TRAILER_SIZE) {
+        __os_heap_debug_report(_handle, _ptr, _t, "overrun");
+        return false;
+    }
+    for (unsigned char *_p = (unsigned char *)_ptr + _t->_size; _p < (unsigned char *)_t; ++_p) {
+        if (*_p != HEAP_DEBUG_FILL) {
+            __os_heap_debug_report(_handle, _ptr, _t, "overrun");
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Freeing or resizing a block may merge it into its free predecessor and
+ * absorb its free successor. Splits never move a block start, so the
+ * verifier only has to start over when its cursor is one of these two.
+ */
+os_private inline void __os_heap_verify_forget(OS_MALLOC_HANDLE _handle, void *_ptr)
+{
+    struct heap_counters *_c = __os_heap_counters(_handle);
+
+    if (_c->_verify_cursor == _ptr ||
+        _c->_verify_cursor == __os_heap_block_walk(_handle, _ptr))
+        _c->_verify_cursor = NULL;
+}
+
+#else
+
+#define __OS_HEAP_CALLER (0)
+#define __os_heap_debug_flush()
+
+#endif
+
+#if defined(CONFIG_OS_MALLOC_TASK_STATS) || defined(CONFIG_OS_MALLOC_DEBUG)
+
+/**
+ * The owner recorded for blocks of a task. With CONFIG_OS_MALLOC_TASK_STATS it
+ * carries the task's generation, so a task that reuses the id of an exited
+ * one is not charged for the blocks the exited task left behind.
+ */
+os_private inline unsigned int __os_heap_owner_of(struct task_control_block *_tcb)
+{
+#ifdef CONFIG_OS_MALLOC_TASK_STATS
+    return _tcb->_task_id | (_tcb->_heap_gen << HEAP_OWNER_ID_BITS);
+#else
+    return _tcb->_task_id;
+#endif
+}
+
+/**
+ * The live task that owns a block, NULL if it has exited.
+ */
+os_private inline struct task_control_block *__os_heap_owner_tcb(unsigned int _owner)
+{
+    struct task_control_block *_tcb = os_task_get_by_id(_owner & HEAP_OWNER_ID_MASK);
+    return (NULL != _tcb && __os_heap_owner_of(_tcb) == _owner) ? _tcb : NULL;
+}
+
+#endif
+
+/**
+ * Fill in the trailer of a block handed out for _size bytes.
+ */
+os_private inline void __os_heap_trailer_set(void *_ptr, unsigned int _size, unsigned int _pc)
+{
+#if defined(CONFIG_OS_MALLOC_TASK_STATS) || defined(CONFIG_OS_MALLOC_DEBUG)
+    struct task_control_block *_tcb = os_get_current_task_tcb();
+    // A block allocated in an interrupt belongs to no task, not to the interrupted one.
+    __os_heap_trailer(_ptr)->_owner = (NULL == _tcb || os_sys_is_in_irq()) ? HEAP_OWNER_NONE : __os_heap_owner_of(_tcb);
+#endif
+#ifdef CONFIG_OS_MALLOC_DEBUG
+    __os_heap_debug_stamp(_ptr, _size, _pc);
+#endif
+}
+
+/**
+ * Histogram bucket of a request: <=16, <=32, ... <=1024 and >1024 bytes.
+ */
+os_private inline unsigned int __os_heap_hist_index(unsigned int _size)
+{
+    unsigned int _i = 0;
+
+    for (_size = (_size - 1) >> 4; _size != 0 && _i < OS_MALLOC_HIST_NUM - 1; _size >>= 1)
+        _i++;
+    return _i;
+}
+
+/**
+ * Account a block that has just been handed out, and charge it to the task
+ * in its trailer. Allocations before the scheduler starts, and allocations
+ * in interrupts, belong to no task.
+ */
+os_private void __os_heap_stat_add(OS_MALLOC_HANDLE _handle, void *_ptr)
+{
+    struct heap_counters *_c = __os_heap_counters(_handle);
+    unsigned int _bytes = __os_heap_usable_size(_ptr) + HEAP_BLOCK_HEAD_SIZE;
+
+    _c->_used += _bytes;
+    if (_c->_used > _c->_peak)
+        _c->_peak = _c->_used;
+    _c->_alloc_num++;
+#ifdef CONFIG_OS_MALLOC_TASK_STATS
+    struct task_control_block *_tcb = __os_heap_owner_tcb(__os_heap_trailer(_ptr)->_owner);
+    if (NULL != _tcb)
+        _tcb->_heap_bytes += _bytes;
+#endif
+}
+
+/**
+ * Account a block that is about to go back to the heap. A task that has
+ * exited is no longer charged, nor is a later task that reused its id.
+ */
+os_private void __os_heap_stat_sub(OS_MALLOC_HANDLE _handle, void *_ptr)
+{
+    struct heap_counters *_c = __os_heap_counters(_handle);
+    unsigned int _bytes = __os_heap_usable_size(_ptr) + HEAP_BLOCK_HEAD_SIZE;
+
+    _c->_used -= _bytes;
+    _c->_alloc_num--;
+#ifdef CONFIG_OS_MALLOC_TASK_STATS
+    struct task_control_block *_tcb = __os_heap_owner_tcb(__os_heap_trailer(_ptr)->_owner);
+    if (NULL != _tcb)
+        _tcb->_heap_bytes -= (_tcb->_heap_bytes < _bytes) ? _tcb->_heap_bytes : _bytes;
+#endif
+}
+
+/**
+ * Account a request of _size bytes in the size histogram.
+ */
+os_private inline void __os_heap_hist_add(OS_MALLOC_HANDLE _handle, unsigned int _size)
+{
+    os_atomic_add(&__os_heap_counters(_handle)->_hist[__os_heap_hist_index(_size)], 1);
+}
+
+/**
+ * Allocate from a heap and keep its counters up to date, except the size
+ * histogram which counts requests, see __os_heap_malloc().
+ *
+ * @param[in] _handle The heap.
+ * @param[in] _size   The size of the memory block to be allocated.
+ * @param[in] _align  0 for the natural 4 bytes alignment, otherwise a power of 2.
+ * @param[in] _pc     Return address of the public call, see __OS_HEAP_CALLER.
+ *
+ * @return A pointer to the allocated memory block.
+ */
+os_private void *__os_heap_alloc(OS_MALLOC_HANDLE _handle, unsigned int _size,
+                                 unsigned int _align, unsigned int _pc)
+{
+    void *_ptr;
+
+    if (_size == 0 || _size > ~0U - HEAP_TRAILER_SIZE)
+        return NULL;
+    if (_align == 0)
+        _ptr = __os_malloc_base(_handle, _size + HEAP_TRAILER_SIZE);
+    else
+        _ptr = __os_malloc_aligned_base(_handle, _size + HEAP_TRAILER_SIZE, _align);
+    if (_ptr != NULL) {
+        __os_heap_trailer_set(_ptr, _size, _pc);
+        __os_heap_stat_add(_handle, _ptr);
+    }
+    return _ptr;
+}
+
+os_private void *__os_heap_malloc(OS_MALLOC_HANDLE _handle, unsigned int _size,
+                                  unsigned int _align, unsigned int _pc)
+{
+    void *_ptr = __os_heap_alloc(_handle, _size, _align, _pc);
+
+    if (_ptr != NULL)
+        __os_heap_hist_add(_handle, _size);
+    return _ptr;
+}
+
+os_private void __os_heap_free(OS_MALLOC_HANDLE _handle, void *_ptr)
+{
+    if (_ptr == NULL)
+        return;
+#ifdef CONFIG_OS_MALLOC_DEBUG
+    // Leak a bad block rather than spread the damage.
+    if (!__os_heap_debug_check(_handle, _ptr, false))
+        return;
+#endif
+    __os_heap_stat_sub(_handle, _ptr);
+#ifdef CONFIG_OS_MALLOC_DEBUG
+    __os_heap_verify_forget(_handle, _ptr);
+#endif
+    __os_free_base(_handle, _ptr);
+}
+
+/**
+ * Resize a block, in place when possible, otherwise move it within the same heap.
+ * Both blocks are 4 bytes aligned, so the move copies whole words.
+ */
+os_private void *__os_realloc_base(OS_MALLOC_HANDLE _handle, void *_ptr,
+                                   unsigned int _size, unsigned int _pc)
+{
+    if (_ptr == NULL)
+        return __os_heap_malloc(_handle, _size, 0, _pc);
+    if (_size == 0) {
+        __os_heap_free(_handle, _ptr);
+        return NULL;
+    }
+    if (_size > ~0U - HEAP_TRAILER_SIZE)
+        return NULL;
+#ifdef CONFIG_OS_MALLOC_DEBUG
+    if (!__os_heap_debug_check(_handle, _ptr, false))
+        return NULL;
+#endif
+
+    __os_heap_stat_sub(_handle, _ptr);
+#ifdef CONFIG_OS_MALLOC_DEBUG
+    __os_heap_verify_forget(_handle, _ptr);
+#endif
+    bool _resized = __os_heap_resize(_handle, _ptr, _size + HEAP_TRAILER_SIZE);
+    if (_resized)
+        __os_heap_trailer_set(_ptr, _size, _pc);
+    __os_heap_stat_add(_handle, _ptr);
+    if (_resized)
+        return _ptr;
+
+    unsigned int *_new = (unsigned int *)__os_heap_malloc(_handle, _size, 0, _pc);
+    if (_new == NULL)
+        return NULL;
+    unsigned int _copy = __os_heap_usable_size(_ptr) - HEAP_TRAILER_SIZE;
+    if (_copy > _size)
+        _copy = (_size + 3) & ~3U;
+    for (unsigned int _i = 0; _i < _copy / sizeof(unsigned int); ++_i)
+        _new[_i] = ((unsigned int *)_ptr)[_i];
+    __os_heap_free(_handle, _ptr);
+    return (void *)_new;
+}
+
+#if CONFIG_OS_MALLOC_CACHE_NUM > 0
+
+os_private inline unsigned int __os_malloc_cache_class_size(unsigned int _cls)
+{
+    return OS_MALLOC_CACHE_CLASS_MIN << _cls;
+}
+
+/**
+ * The smallest class that holds a request, OS_MALLOC_CACHE_CLASS_NUM if none does.
+ */
+os_private inline unsigned int __os_malloc_cache_class(unsigned int _size)
+{
+    unsigned int _cls = 0;
+
+    if (_size == 0)
+        return OS_MALLOC_CACHE_CLASS_NUM;
+    while (_cls < OS_MALLOC_CACHE_CLASS_NUM && _size > __os_malloc_cache_class_size(_cls))
+        _cls++;
+    return _cls;
+}
+
+/**
+ * The largest class a freed block can serve, OS_MALLOC_CACHE_CLASS_NUM if it
+ * is too small, or so large that caching it would waste memory.
+ */
+os_private unsigned int __os_malloc_cache_class_of(void *_ptr)
+{
+    unsigned int _cap = __os_heap_usable_size(_ptr) - HEAP_TRAILER_SIZE;
+    unsigned int _cls = OS_MALLOC_CACHE_CLASS_NUM;
 
-struct small_memory_header {
-    unsigned short _magic;
-    bool _used;
-    unsigned int _size; // bytes
-    struct list_head _nd;
-};
+    if (_cap < OS_MALLOC_CACHE_CLASS_MIN ||
+        _cap >= __os_malloc_cache_class_size(OS_MALLOC_CACHE_CLASS_NUM))
+        return OS_MALLOC_CACHE_CLASS_NUM;
+    while (_cap < __os_malloc_cache_class_size(_cls))
+        _cls--;
+    return _cls;
+}
 
 /**
- * Called by os_board_init(), the size of heap must be CONFIG_HEAP_SIZE
- *
- * @param[in/out] ptr      The head of the heap.
- *
- * @return        void
+ * The cache of the current task, NULL before the scheduler starts.
  */
-void os_set_usr_heap_head(void* ptr)
+os_private inline struct os_malloc_cache *__os_malloc_cache_current(void)
 {
-    heap.heap_head = ptr;
-    heap.heap_size = CONFIG_HEAP_SIZE;
+    struct task_control_block *_tcb = os_get_current_task_tcb();
+    return (NULL == _tcb) ? NULL : &_tcb->_heap_cache;
 }
 
-void os_set_kernel_heap_head(void* ptr)
+// A cached block links to the next one through its first word.
+os_private inline void __os_malloc_cache_push(struct os_malloc_cache *_cache, unsigned int _cls, void *_blk)
 {
-    kernel_heap.heap_head = ptr;
-    kernel_heap.heap_size = CONFIG_KERNEL_HEAP_SIZE;
+#ifdef CONFIG_OS_MALLOC_DEBUG
+    // Before the link: it may overwrite slack the live canary still vouches for.
+    __os_heap_trailer(_blk)->_canary = HEAP_DEBUG_CACHED ^ (unsigned int)_blk;
+    __OS_HEAP_DEBUG_BARRIER
+#endif
+    *(void **)_blk = _cache->_head[_cls];
+    _cache->_head[_cls] = _blk;
+    _cache->_num[_cls]++;
+}
+
+os_private inline void *__os_malloc_cache_pop(struct os_malloc_cache *_cache, unsigned int _cls)
+{
+    void *_blk = _cache->_head[_cls];
+    if (_blk != NULL) {
+        _cache->_head[_cls] = *(void **)_blk;
+        _cache->_num[_cls]--;
+#ifdef CONFIG_OS_MALLOC_DEBUG
+        // Live again, spanning the whole block until the caller stamps it.
+        __os_heap_debug_stamp(_blk, __os_heap_usable_size(_blk) - HEAP_TRAILER_SIZE, __os_heap_trailer(_blk)->_pc);
+#endif
+    }
+    return _blk;
 }
 
 /**
- * Initialize the memory manage subsystem.
- *
- * In EPoseRTOS, it is called in os_sys_init() function
+ * Take a block from the task cache, refilling the class with a batch from
+ * the user heap under one lock when it is empty.
  */
-void os_memory_init(void)
+os_private void *__os_malloc_cache_get(struct os_malloc_cache *_cache, unsigned int _cls, unsigned int _pc)
 {
-    os_mutex_init(&_usr_memery_op_mutex, OS_MUTEX_RECURSIVE);
-    OS_ASSERT(heap.heap_head != NULL);
-    struct small_memory_header *_m = (struct small_memory_header *)heap.heap_head;
-    _m->_magic = HEAP_MEM_MAGIC;
-    _m->_size = heap.heap_size;
-    _m->_used = false;
-    list_add_tail(&heap_list_head, &(_m->_nd));
+    void *_ret = __os_malloc_cache_pop(_cache, _cls);
 
-    OS_ASSERT(kernel_heap.heap_head != NULL);
-    struct small_memory_header *_m_kernel = (struct small_memory_header *)kernel_heap.heap_head;
-    _m_kernel->_magic = HEAP_MEM_MAGIC;
-    _m_kernel->_size = kernel_heap.heap_size;
-    _m_kernel->_used = false;
-    list_add_tail(&kernel_heap_list_head, &(_m_kernel->_nd));
+    if (_ret != NULL)
+        return _ret;
+    os_mutex_lock(&_usr_memery_op_mutex, OS_MUTEX_NEVER_TIMEOUT);
+    _ret = __os_heap_alloc(_usr_heap, __os_malloc_cache_class_size(_cls), 0, _pc);
+    for (unsigned int _i = 1; _ret != NULL && _i < CONFIG_OS_MALLOC_CACHE_BATCH; ++_i) {
+        void *_blk = __os_heap_alloc(_usr_heap, __os_malloc_cache_class_size(_cls), 0, _pc);
+        if (_blk == NULL)
+            break;
+        __os_malloc_cache_push(_cache, _cls, _blk);
+    }
+    os_mutex_unlock(&_usr_memery_op_mutex);
+    return _ret;
 }
 
 /**
- * Allocate memory from the list_head(mounted with an unallocated memory).
- *
- * @param[in/out] _heap_list_head The head of the heap list.
- * @param[in]     _size(byte)     The size of the memory block to be allocated.
+ * Keep a freed block in the task cache, returning a batch of the class to
+ * the user heap under one lock when it is full.
+ */
+os_private void __os_malloc_cache_put(struct os_malloc_cache *_cache, unsigned int _cls, void *_ptr)
+{
+    if (_cache->_num[_cls] >= CONFIG_OS_MALLOC_CACHE_NUM) {
+        os_mutex_lock(&_usr_memery_op_mutex, OS_MUTEX_NEVER_TIMEOUT);
+        for (unsigned int _i = 0; _i < CONFIG_OS_MALLOC_CACHE_BATCH; ++_i)
+            __os_heap_free(_usr_heap, __os_malloc_cache_pop(_cache, _cls));
+        os_mutex_unlock(&_usr_memery_op_mutex);
+        __os_heap_debug_flush();
+    }
+    __os_malloc_cache_push(_cache, _cls, _ptr);
+}
+
+void os_malloc_cache_init(struct os_malloc_cache *_cache)
+{
+    for (unsigned int _i = 0; _i < OS_MALLOC_CACHE_CLASS_NUM; ++_i) {
+        _cache->_head[_i] = NULL;
+        _cache->_num[_i] = 0;
+    }
+}
+
+/**
+ * Return every block cached by the current task to the user heap. Called
+ * when a task exits, a task may also call it to give memory back early.
  *
- * @return                A pointer to the allocated memory block.
+ * @return true if any block was returned.
  */
-os_private void *__os_malloc_base(struct list_head *_heap_list_head,
-                                   unsigned int _size)
+bool os_malloc_cache_flush(void)
 {
-    // size4
-    _size = _size + (4 - (_size % 4));
+    struct os_malloc_cache *_cache = __os_malloc_cache_current();
+    bool _flushed = false;
 
-    struct list_head *_current_node = NULL;
-    struct list_head *_next_node = NULL;
-    list_for_each_safe(_current_node, _next_node, _heap_list_head)
-    {
-        struct small_memory_header *smh = os_list_entry(_current_node, struct small_memory_header, _nd);
-        if (smh->_magic == HEAP_MEM_MAGIC && smh->_used == false) {
-            if (smh->_size >= _size + sizeof(struct small_memory_header)) {
-                //
-                if (smh->_size <= _size + 2 * sizeof(struct small_memory_header)) {
-                    smh->_used = true;
-                    return ((void *)((unsigned char *)smh + sizeof(struct small_memory_header)));
-                } else {
-                    //
-                    struct small_memory_header *next_smh = (struct small_memory_header *)((unsigned char *)smh +
-                                                                                          sizeof(struct small_memory_header) + _size);
-                    next_smh->_magic = HEAP_MEM_MAGIC;
-                    next_smh->_used = false;
-                    next_smh->_size = smh->_size - (sizeof(struct small_memory_header) + _size);
-
-                    smh->_used = true;
-                    smh->_size = sizeof(struct small_memory_header) + _size;
-
-                    list_add(&(smh->_nd), &(next_smh->_nd));
-
-                    return ((void *)((unsigned char *)smh + sizeof(struct small_memory_header)));
-                }
-            }
-        }
+    if (_cache == NULL)
+        return false;
+    for (unsigned int _i = 0; _i < OS_MALLOC_CACHE_CLASS_NUM; ++_i)
+        _flushed = _flushed || (_cache->_head[_i] != NULL);
+    if (!_flushed)
+        return false;
+    os_mutex_lock(&_usr_memery_op_mutex, OS_MUTEX_NEVER_TIMEOUT);
+    for (unsigned int _i = 0; _i < OS_MALLOC_CACHE_CLASS_NUM; ++_i) {
+        while (_cache->_head[_i] != NULL)
+            __os_heap_free(_usr_heap, __os_malloc_cache_pop(_cache, _i));
     }
-    return NULL;
+    os_mutex_unlock(&_usr_memery_op_mutex);
+    __os_heap_debug_flush();
+    return true;
 }
 
+#endif
+
 /**
  * Allocate memory from the kernel heap. **Non-thread-safe**
  *
@@ -138,48 +1118,188 @@ os_private void *__os_malloc_base(struct list_head *_heap_list_head,
  */
 void *os_malloc(unsigned int _size)
 {
-    return __os_malloc_base(&heap_list_head, _size);
+    return __os_heap_malloc(_usr_heap, _size, 0, __OS_HEAP_CALLER);
 }
 
 void *os_calloc(unsigned int _nmemb, unsigned int _size)
 {
     unsigned int _s = _size * _nmemb;
-    void *_mem = __os_malloc_base(&heap_list_head, _s);
+    void *_mem = __os_heap_malloc(_usr_heap, _s, 0, __OS_HEAP_CALLER);
     os_memset(_mem, 0, _s);
     return _mem;
 }
 
-void *os_malloc_safe(unsigned int _size)
+os_private void *__os_malloc_safe_base(unsigned int _size, unsigned int _pc)
 {
+#if CONFIG_OS_MALLOC_CACHE_NUM > 0
+    struct os_malloc_cache *_cache = __os_malloc_cache_current();
+    unsigned int _cls = __os_malloc_cache_class(_size);
+    if (_cache != NULL && _cls < OS_MALLOC_CACHE_CLASS_NUM) {
+        void *_ret = __os_malloc_cache_get(_cache, _cls, _pc);
+        if (_ret != NULL) {
+            __os_heap_hist_add(_usr_heap, _size);
+#ifdef CONFIG_OS_MALLOC_DEBUG
+            __os_heap_debug_stamp(_ret, _size, _pc);
+#endif
+        }
+        return _ret;
+    }
+#endif
     os_mutex_lock(&_usr_memery_op_mutex, OS_MUTEX_NEVER_TIMEOUT);
-    void *ret = __os_malloc_base(&heap_list_head, _size);
+    void *ret = __os_heap_malloc(_usr_heap, _size, 0, _pc);
     os_mutex_unlock(&_usr_memery_op_mutex);
     return ret;
 }
 
+/**
+ * Allocate memory from the user heap. **Thread-safe**
+ *
+ * With CONFIG_OS_MALLOC_CACHE_NUM > 0, requests up to 128 bytes are served
+ * without the lock from the calling task's cache of blocks it has freed with
+ * os_free_safe(). Cached blocks still count as used in the heap statistics.
+ * A task cache holds at most CONFIG_OS_MALLOC_CACHE_NUM blocks of each of the
+ * 16, 32, 64 and 128 bytes classes, that is 240 * CONFIG_OS_MALLOC_CACHE_NUM
+ * bytes plus the block overhead (about 1 KB with the default of 4). When the
+ * heap cannot serve a request, the calling task's cache is returned to it
+ * and the request is tried once more.
+ *
+ * @param[in] _size The size of the memory block to be allocated.
+ *
+ * @return A pointer to the allocated memory block.
+ */
+void *os_malloc_safe(unsigned int _size)
+{
+    void *_ret = __os_malloc_safe_base(_size, __OS_HEAP_CALLER);
+
+#if CONFIG_OS_MALLOC_CACHE_NUM > 0
+    // The memory may be parked in the cache, in this class or in others.
+    if (_ret == NULL && _size != 0 && os_malloc_cache_flush())
+        _ret = __os_malloc_safe_base(_size, __OS_HEAP_CALLER);
+#endif
+    return _ret;
+}
+
 void *os_calloc_safe(unsigned int _nmemb, unsigned int _size)
 {
     unsigned int _s = _size * _nmemb;
+    void *_mem = os_malloc_safe(_s);
+    if (_mem != NULL)
+        os_memset(_mem, 0, _s);
+    return _mem;
+}
+
+/**
+ * Resize memory allocated by os_malloc, in place when the following block is
+ * free, otherwise by moving it. **Non-thread-safe**
+ *
+ * @param[in/out] _ptr  The memory block to be resized, NULL to allocate.
+ * @param[in]     _size The new size, 0 to free.
+ *
+ * @return The resized block, NULL on failure with _ptr left untouched.
+ */
+void *os_realloc(void *_ptr, unsigned int _size)
+{
+    void *_ret = __os_realloc_base(__os_heap_of(_ptr), _ptr, _size, __OS_HEAP_CALLER);
+    __os_heap_debug_flush();
+    return _ret;
+}
+
+void *os_realloc_safe(void *_ptr, unsigned int _size)
+{
     os_mutex_lock(&_usr_memery_op_mutex, OS_MUTEX_NEVER_TIMEOUT);
-    void *_mem = __os_malloc_base(&heap_list_head, _s);
+    void *ret = __os_realloc_base(__os_heap_of(_ptr), _ptr, _size, __OS_HEAP_CALLER);
     os_mutex_unlock(&_usr_memery_op_mutex);
-    os_memset(_mem, 0, _s);
-    return _mem;
+    __os_heap_debug_flush();
+    return ret;
 }
 
+/**
+ * Allocate memory from the kernel heap. **Thread-safe and interrupt-safe**
+ *
+ * The heap is only locked by a critical section with all interrupts masked
+ * around the allocator itself, so interrupt handlers may call it too. With
+ * CONFIG_OS_MALLOC_TLSF that section is O(1); the first-fit allocator walks
+ * its free list, so its cost grows with fragmentation.
+ *
+ * @param[in] _size The size of the memory block to be allocated.
+ *
+ * @return A pointer to the allocated memory block.
+ */
 void* os_kmalloc(unsigned int _size)
 {
-    return __os_malloc_base(&kernel_heap_list_head, _size);
+    OS_ENTER_CRITICAL
+    void *_ret = __os_heap_malloc(_kernel_heap, _size, 0, __OS_HEAP_CALLER);
+    OS_EXIT_CRITICAL
+    return _ret;
 }
 
 void *os_kcalloc(unsigned int _nmemb, unsigned int _size)
 {
     unsigned int _s = _size * _nmemb;
-    void *_mem = __os_malloc_base(&kernel_heap_list_head, _s);
-    os_memset(_mem, 0, _s);
+    void *_mem = os_kmalloc(_s);
+    if (_mem != NULL)
+        os_memset(_mem, 0, _s);
     return _mem;
 }
 
+/**
+ * Resize memory allocated by os_kmalloc. **Thread-safe and interrupt-safe**
+ * A block that cannot grow in place is copied inside the critical section.
+ */
+void *os_krealloc(void *_ptr, unsigned int _size)
+{
+    OS_ENTER_CRITICAL
+    void *_ret = __os_realloc_base(_kernel_heap, _ptr, _size, __OS_HEAP_CALLER);
+    OS_EXIT_CRITICAL
+    __os_heap_debug_flush();
+    return _ret;
+}
+
+/**
+ * Allocate a buffer in interrupt context. **Thread-safe and interrupt-safe**
+ * Free it with os_free_isr().
+ *
+ * With CONFIG_OS_MALLOC_ISR_POOL_NUM > 0, requests up to 256 bytes are served
+ * lock-free from the smallest size-class pool with a free block. Larger
+ * requests, and requests that find their pools empty, fall back to os_kmalloc().
+ * Kernel heap blocks allocated between os_sys_enter_irq() and os_sys_exit_irq()
+ * are charged to no task.
+ *
+ * @param[in] _size The size of the buffer.
+ *
+ * @return A pointer to the buffer.
+ */
+void *os_malloc_isr(unsigned int _size)
+{
+    if (_size == 0)
+        return NULL;
+#if CONFIG_OS_MALLOC_ISR_POOL_NUM > 0
+    for (unsigned int _i = 0; _i < OS_MALLOC_ISR_CLASS_NUM; ++_i) {
+        if (_size > _isr_pools[_i]._blk_size)
+            continue;
+        void *_ret = os_mempool_alloc(&_isr_pools[_i]);
+        if (_ret != NULL)
+            return _ret;
+    }
+#endif
+    return os_kmalloc(_size);
+}
+
+void os_free_isr(void *_ptr)
+{
+    if (_ptr == NULL)
+        return;
+#if CONFIG_OS_MALLOC_ISR_POOL_NUM > 0
+    for (unsigned int _i = 0; _i < OS_MALLOC_ISR_CLASS_NUM; ++_i) {
+        if (os_mempool_owns(&_isr_pools[_i], _ptr)) {
+            os_mempool_free(&_isr_pools[_i], _ptr);
+            return;
+        }
+    }
+#endif
+    os_kfree(_ptr);
+}
+
 /**
  * Construct kernel-recognizable memory data structure from user-provided memory.
  *
@@ -197,17 +1317,111 @@ OS_MALLOC_HANDLE os_malloc_keep(void *_m_head, unsigned int _size)
     if (_size < OS_MALLOC_MIN_KEEP_SIZE)
         return 0;
 
-    struct list_head *keep_head = (struct list_head *)_m_head;
-    list_head_init(keep_head);
+    struct heap_counters *_c = (struct heap_counters *)_m_head;
+    os_memset(_c, 0, sizeof(struct heap_counters));
+#ifdef CONFIG_OS_MALLOC_DEBUG
+    _c->_end = (unsigned char *)_m_head + _size;
+#endif
+    OS_MALLOC_HANDLE _handle = __os_heap_create((void *)(_c + 1), _size - sizeof(struct heap_counters));
+    if (_handle == 0)
+        return 0;
+    // The pool is one free block now.
+    unsigned int _free_num;
+    __os_heap_free_info(_handle, &_free_num, &_c->_total);
+    return _handle;
+}
 
-    struct small_memory_header *_m =
-        (struct small_memory_header *)((unsigned int)_m_head + sizeof(struct list_head));
-    _m->_magic = HEAP_MEM_MAGIC;
-    _m->_size = _size - sizeof(struct list_head);
-    _m->_used = false;
-    list_add_tail(keep_head, &(_m->_nd));
+/**
+ * Register a memory block as a heap region, e.g. TCM, non-cacheable SRAM or
+ * external SDRAM. Called by os_board_init() or before any os_malloc_caps().
+ *
+ * @param[in/out] _m_head The starting address of the region.
+ * @param[in]     _size   The size of the region.
+ * @param[in]     _caps   OS_MALLOC_CAP_* attributes of the region.
+ *
+ * @return OS_HANDLE_FAIL if the region table is full or the memory is too small.
+ */
+os_handle_state_t os_heap_region_add(void *_m_head, unsigned int _size, unsigned int _caps)
+{
+    if (_heap_region_num >= CONFIG_OS_HEAP_REGION_NUM)
+        return OS_HANDLE_FAIL;
+    OS_MALLOC_HANDLE _handle = os_malloc_keep(_m_head, _size);
+    if (_handle == 0)
+        return OS_HANDLE_FAIL;
+    _heap_regions[_heap_region_num]._handle = _handle;
+    _heap_regions[_heap_region_num]._start = (unsigned char *)_m_head;
+    _heap_regions[_heap_region_num]._end = (unsigned char *)_m_head + _size;
+    _heap_regions[_heap_region_num]._caps = _caps;
+    _heap_region_num++;
+    return OS_HANDLE_SUCCESS;
+}
 
-    return (OS_MALLOC_HANDLE)keep_head;
+/**
+ * Allocate memory from the first region, in registration order with the user
+ * heap first, that has all of the requested capabilities. **Thread-safe**
+ * Free it with os_free_safe().
+ *
+ * @param[in] _size The size of the memory block to be allocated.
+ * @param[in] _caps OS_MALLOC_CAP_* attributes the memory must have.
+ *
+ * @return A pointer to the allocated memory block, NULL if no such region has room.
+ */
+void *os_malloc_caps(unsigned int _size, unsigned int _caps)
+{
+    void *_ret = NULL;
+
+    os_mutex_lock(&_usr_memery_op_mutex, OS_MUTEX_NEVER_TIMEOUT);
+    for (unsigned int _i = 0; _i < _heap_region_num && _ret == NULL; ++_i) {
+        if (_heap_regions[_i]._handle != 0 &&
+            (_heap_regions[_i]._caps & _caps) == _caps)
+            _ret = __os_heap_malloc(_heap_regions[_i]._handle, _size, 0, __OS_HEAP_CALLER);
+    }
+    os_mutex_unlock(&_usr_memery_op_mutex);
+    return _ret;
+}
+
+/**
+ * Allocate memory from the user heap whose address is a multiple of _align.
+ * **Non-thread-safe**, free it with os_free().
+ *
+ * @param[in] _size  The size of the memory block to be allocated.
+ * @param[in] _align The alignment, a power of 2.
+ *
+ * @return A pointer to the allocated memory block.
+ */
+void *os_malloc_aligned(unsigned int _size, unsigned int _align)
+{
+    if (_align == 0)
+        return NULL;
+    return __os_heap_malloc(_usr_heap, _size, _align, __OS_HEAP_CALLER);
+}
+
+/**
+ * Allocate a DMA buffer from the regions with OS_MALLOC_CAP_DMA. It starts on
+ * a cache line and is rounded up to whole lines, so cache maintenance on it
+ * never touches a neighbouring allocation. **Thread-safe**
+ * Free it with os_free_safe().
+ *
+ * @param[in] _size The size of the buffer.
+ *
+ * @return A pointer to the buffer, NULL if no DMA-capable region has room.
+ */
+void *os_malloc_dma(unsigned int _size)
+{
+    void *_ret = NULL;
+
+    if (_size == 0 || _size > ~0U - CONFIG_OS_CACHE_LINE_SIZE)
+        return NULL;
+    _size = (_size + CONFIG_OS_CACHE_LINE_SIZE - 1) & ~(CONFIG_OS_CACHE_LINE_SIZE - 1);
+    os_mutex_lock(&_usr_memery_op_mutex, OS_MUTEX_NEVER_TIMEOUT);
+    for (unsigned int _i = 0; _i < _heap_region_num && _ret == NULL; ++_i) {
+        if (_heap_regions[_i]._handle != 0 &&
+            (_heap_regions[_i]._caps & OS_MALLOC_CAP_DMA))
+            _ret = __os_heap_malloc(_heap_regions[_i]._handle, _size, CONFIG_OS_CACHE_LINE_SIZE,
+                                        __OS_HEAP_CALLER);
+    }
+    os_mutex_unlock(&_usr_memery_op_mutex);
+    return _ret;
 }
 
 /**
@@ -223,50 +1437,7 @@ void *os_malloc_usr(OS_MALLOC_HANDLE _handle, unsigned int _size)
     if (_handle == 0)
         return NULL;
 
-    return __os_malloc_base((struct list_head *)_handle, _size);
-}
-
-os_private void __os_free_base(struct list_head *_heap_list_head,
-                                void *_ptr)
-{
-    if (_ptr == NULL)
-        return;
-
-    struct small_memory_header *smh = (struct small_memory_header *)((unsigned char *)_ptr -
-                                                                     sizeof(struct small_memory_header));
-    smh->_used = false;
-
-    struct list_head *_tmp_nd = &(smh->_nd);
-    struct list_head *_assist_nd = NULL;
-
-    struct small_memory_header *smh_this = NULL;
-    struct small_memory_header *smh_next = NULL;
-    
-    while (_tmp_nd->prev != _heap_list_head) {
-        smh_this = os_list_entry(_tmp_nd, struct small_memory_header, _nd);
-        smh_next = os_list_entry(_tmp_nd->prev, struct small_memory_header, _nd);
-        _assist_nd = _tmp_nd->prev;
-        if (smh_next->_magic == HEAP_MEM_MAGIC && smh_next->_used == false) {
-            smh_next->_size += smh_this->_size;
-            list_del(_tmp_nd);
-        } else {
-            break;
-        }
-        _tmp_nd = _assist_nd;
-    }
-    
-    while (_tmp_nd->next != _heap_list_head) {
-        smh_this = os_list_entry(_tmp_nd, struct small_memory_header, _nd);
-        smh_next = os_list_entry(_tmp_nd->next, struct small_memory_header, _nd);
-        //_assist_nd = _tmp_nd->next;
-        if (smh_next->_magic == HEAP_MEM_MAGIC && smh_next->_used == false) {
-            smh_this->_size += smh_next->_size;
-            list_del(_tmp_nd->next);
-        } else {
-            break;
-        }
-        //_tmp_nd = _assist_nd;
-    }
+    return __os_heap_malloc(_handle, _size, 0, __OS_HEAP_CALLER);
 }
 
 /**
@@ -276,19 +1447,40 @@ os_private void __os_free_base(struct list_head *_heap_list_head,
  */
 void os_free(void *_ptr)
 {
-    __os_free_base(&heap_list_head, _ptr);
+    __os_heap_free(__os_heap_of(_ptr), _ptr);
+    __os_heap_debug_flush();
 }
 
 void os_free_safe(void *_ptr)
 {
+#if CONFIG_OS_MALLOC_CACHE_NUM > 0
+    struct os_malloc_cache *_cache = __os_malloc_cache_current();
+    if (_cache != NULL && _ptr != NULL && __os_heap_of(_ptr) == _usr_heap) {
+#ifdef CONFIG_OS_MALLOC_DEBUG
+        if (!__os_heap_debug_check(_usr_heap, _ptr, false)) {
+            __os_heap_debug_flush();
+            return;
+        }
+#endif
+        unsigned int _cls = __os_malloc_cache_class_of(_ptr);
+        if (_cls < OS_MALLOC_CACHE_CLASS_NUM) {
+            __os_malloc_cache_put(_cache, _cls, _ptr);
+            return;
+        }
+    }
+#endif
     os_mutex_lock(&_usr_memery_op_mutex, OS_MUTEX_NEVER_TIMEOUT);
-    __os_free_base(&heap_list_head, _ptr);
+    __os_heap_free(__os_heap_of(_ptr), _ptr);
     os_mutex_unlock(&_usr_memery_op_mutex);
+    __os_heap_debug_flush();
 }
 
 void os_kfree(void *_ptr)
 {
-    __os_free_base(&kernel_heap_list_head, _ptr);
+    OS_ENTER_CRITICAL
+    __os_heap_free(_kernel_heap, _ptr);
+    OS_EXIT_CRITICAL
+    __os_heap_debug_flush();
 }
 
 /**
@@ -299,46 +1491,222 @@ void os_kfree(void *_ptr)
  */
 void os_free_usr(OS_MALLOC_HANDLE _handle, void *_ptr)
 {
-    __os_free_base((struct list_head *)_handle, _ptr);
+    __os_heap_free(_handle, _ptr);
+    __os_heap_debug_flush();
 }
 
-OS_CMD_PROCESS_FN(memory_used)
+os_private void __os_heap_stats_snapshot(OS_MALLOC_HANDLE _handle, struct os_heap_stats *_stats)
 {
-    unsigned int _used_m = 0;
-    struct list_head *_current_pos;
-    struct small_memory_header *smh_this = NULL;
-    __OS_OWNED_ENTER_CRITICAL;
-    list_for_each(_current_pos, &heap_list_head)
-    {
-        smh_this = os_list_entry(_current_pos, struct small_memory_header, _nd);
-        if (smh_this->_used == true)
-            _used_m += smh_this->_size;
+    struct heap_counters *_c = __os_heap_counters(_handle);
+    unsigned int _largest;
+
+    _stats->total_size = _c->_total;
+    _stats->used_size = _c->_used;
+    _stats->peak_size = _c->_peak;
+    _stats->alloc_num = _c->_alloc_num;
+    for (unsigned int _i = 0; _i < OS_MALLOC_HIST_NUM; ++_i)
+        _stats->hist[_i] = (unsigned int)os_atomic_load(&_c->_hist[_i]);
+#ifdef CONFIG_OS_MALLOC_DEBUG
+    _stats->corrupt_num = _c->_corrupt_num;
+#else
+    _stats->corrupt_num = 0;
+#endif
+    __os_heap_free_info(_handle, &_stats->free_num, &_largest);
+    _stats->largest_free = _largest > HEAP_BLOCK_HEAD_SIZE ? _largest - HEAP_BLOCK_HEAD_SIZE : 0;
+}
+
+/**
+ * Take a snapshot of a heap's statistics. The counters are copied in O(1),
+ * only finding the largest free block may look at free blocks: TLSF searches
+ * its highest size class, first-fit walks the free list.
+ *
+ * The snapshot is taken under the lock of the heap: a critical section for
+ * the kernel heap, the user heap mutex for every other heap, so a first-fit
+ * walk never runs with interrupts off outside the kernel heap. Not to be
+ * called from an interrupt.
+ *
+ * @param[in]  _handle The return value of os_malloc_keep(...).
+ * @param[out] _stats  The snapshot.
+ *
+ * @return OS_HANDLE_FAIL if the handle or _stats is NULL.
+ */
+os_handle_state_t os_malloc_get_stats(OS_MALLOC_HANDLE _handle, struct os_heap_stats *_stats)
+{
+    if (_handle == 0 || _stats == NULL)
+        return OS_HANDLE_FAIL;
+
+    if (_handle == _kernel_heap) {
+        OS_ENTER_CRITICAL
+        __os_heap_stats_snapshot(_handle, _stats);
+        OS_EXIT_CRITICAL
+    } else {
+        os_mutex_lock(&_usr_memery_op_mutex, OS_MUTEX_NEVER_TIMEOUT);
+        __os_heap_stats_snapshot(_handle, _stats);
+        os_mutex_unlock(&_usr_memery_op_mutex);
+    }
+    return OS_HANDLE_SUCCESS;
+}
+
+os_handle_state_t os_malloc_stats(struct os_heap_stats *_stats)
+{
+    return os_malloc_get_stats(_usr_heap, _stats);
+}
+
+os_handle_state_t os_kmalloc_stats(struct os_heap_stats *_stats)
+{
+    return os_malloc_get_stats(_kernel_heap, _stats);
+}
+
+#ifdef CONFIG_OS_MALLOC_DEBUG
+
+// One step of os_malloc_verify(), with the heap locked.
+os_private unsigned int __os_heap_verify_step(OS_MALLOC_HANDLE _handle, unsigned int _budget)
+{
+    struct heap_counters *_c = __os_heap_counters(_handle);
+    unsigned int _bad = 0;
+
+    for (; _budget != 0; --_budget) {
+        void *_ptr = __os_heap_block_walk(_handle, _c->_verify_cursor);
+        if (_ptr == NULL) {
+            // One pass done, start over next time.
+            _c->_verify_cursor = NULL;
+            break;
+        }
+        if (!__os_heap_block_check(_handle, _ptr)) {
+            // The walk cannot go past a broken header.
+            __os_heap_debug_report(_handle, _ptr, NULL, "broken block");
+            _c->_verify_cursor = NULL;
+            _bad++;
+            break;
+        }
+        if (__os_heap_block_is_used(_ptr) && !__os_heap_debug_check(_handle, _ptr, true))
+            _bad++;
+        _c->_verify_cursor = _ptr;
+    }
+    return _bad;
+}
+
+/**
+ * Check up to _budget blocks of a heap, resuming where the previous call
+ * stopped. The walk restarts from the first block only when the block it
+ * stopped at has been merged away since the previous step.
+ *
+ * The step runs under the lock of the heap, a critical section for the
+ * kernel heap and the user heap mutex for every other heap, with the
+ * scheduler locked as well since task caches are used without the mutex.
+ * Its cost is bounded by _budget. Not to be called from an interrupt.
+ *
+ * @param[in] _handle The return value of os_malloc_keep(...).
+ * @param[in] _budget The number of blocks to check.
+ *
+ * @return The number of bad blocks found in this step.
+ */
+unsigned int os_malloc_verify(OS_MALLOC_HANDLE _handle, unsigned int _budget)
+{
+    unsigned int _bad;
+
+    if (_handle == 0)
+        return 0;
+
+    if (_handle == _kernel_heap) {
+        OS_ENTER_CRITICAL
+        _bad = __os_heap_verify_step(_handle, _budget);
+        OS_EXIT_CRITICAL
+    } else {
+        os_mutex_lock(&_usr_memery_op_mutex, OS_MUTEX_NEVER_TIMEOUT);
+        __OS_OWNED_ENTER_CRITICAL
+        _bad = __os_heap_verify_step(_handle, _budget);
+        __OS_OWNED_EXIT_CRITICAL
+        os_mutex_unlock(&_usr_memery_op_mutex);
+    }
+    __os_heap_debug_flush();
+    return _bad;
+}
+
+/**
+ * One verifier step over every heap region and the kernel heap.
+ *
+ * @return The number of bad blocks found in this step.
+ */
+unsigned int os_malloc_verify_all(unsigned int _budget)
+{
+    unsigned int _bad = 0;
+
+    for (unsigned int _i = 0; _i < _heap_region_num; ++_i)
+        _bad += os_malloc_verify(_heap_regions[_i]._handle, _budget);
+    return _bad + os_malloc_verify(_kernel_heap, _budget);
+}
+
+os_private void __os_malloc_verifier(void *_arg)
+{
+    while (1) {
+        os_malloc_verify_all(CONFIG_OS_MALLOC_VERIFY_BUDGET);
+        os_task_delay_ms(CONFIG_OS_MALLOC_VERIFY_PERIOD_MS);
     }
-    __OS_OWNED_EXIT_CRITICAL;
-    unsigned int _mleft = CONFIG_HEAP_SIZE - _used_m;
-    os_printk(":heap used->%d\r\n", _used_m);
+}
+
+/**
+ * Create a task that keeps verifying every heap in small steps, the control
+ * block and the stack are provided by the caller. A low priority is usual.
+ */
+os_handle_state_t os_malloc_verifier_create(struct task_control_block *_tcb,
+                                            unsigned int *_stack, unsigned int _stack_size,
+                                            unsigned char _prio)
+{
+    return os_task_create(_tcb, _stack, _stack_size, _prio, __os_malloc_verifier, NULL, "heap_verify");
+}
+
+#endif
+
+os_private unsigned int __os_heap_stats_print(OS_MALLOC_HANDLE _handle)
+{
+    struct os_heap_stats _s;
+
+    if (OS_HANDLE_FAIL == os_malloc_get_stats(_handle, &_s))
+        return 0;
+    unsigned int _mleft = _s.total_size - _s.used_size;
+    // How much of the free memory is out of reach of the largest request.
+    unsigned int _frag = (_mleft == 0 || _s.largest_free >= _mleft) ? 0 : 100 - _s.largest_free * 100 / _mleft;
+    os_printk(":heap used->%d\r\n", _s.used_size);
     os_printk(":heap left->%d\r\n", _mleft);
+    os_printk(":heap peak->%d\r\n", _s.peak_size);
+    os_printk(":heap blocks->%d used, %d free\r\n", _s.alloc_num, _s.free_num);
+    os_printk(":heap largest free->%d, fragmentation %d%%\r\n", _s.largest_free, _frag);
+#ifdef CONFIG_OS_MALLOC_DEBUG
+    os_printk(":heap corrupted->%d\r\n", _s.corrupt_num);
+#endif
+    os_printk(":heap sizes->");
+    for (unsigned int _i = 0; _i < OS_MALLOC_HIST_NUM - 1; ++_i)
+        os_printk(" <=%d:%d", 16U << _i, _s.hist[_i]);
+    os_printk(" >%d:%d\r\n", 16U << (OS_MALLOC_HIST_NUM - 2), _s.hist[OS_MALLOC_HIST_NUM - 1]);
     return _mleft;
 }
+
+OS_CMD_PROCESS_FN(memory_used)
+{
+    return __os_heap_stats_print(_usr_heap);
+}
 OS_CMD_EXPORT(free, memory_used, "List the usage of user's heap.");
 
 OS_CMD_PROCESS_FN(kernel_memory_used)
 {
-    unsigned int _used_m = 0;
-    struct list_head *_current_pos;
-    struct small_memory_header *smh_this = NULL;
-    __OS_OWNED_ENTER_CRITICAL;
-    list_for_each(_current_pos, &kernel_heap_list_head)
-    {
-        smh_this = os_list_entry(_current_pos, struct small_memory_header, _nd);
-        if (smh_this->_used == true)
-            _used_m += smh_this->_size;
-    }
-    __OS_OWNED_EXIT_CRITICAL;
-    unsigned int _mleft = CONFIG_HEAP_SIZE - _used_m;
-    os_printk(":heap used->%d\r\n", _used_m);
-    os_printk(":heap left->%d\r\n", _mleft);
-    return _mleft;
+    return __os_heap_stats_print(_kernel_heap);
 }
 
 OS_CMD_EXPORT(kfree, kernel_memory_used, "List the usage of kernel's heap.");
+
+#ifdef CONFIG_OS_MALLOC_TASK_STATS
+
+OS_CMD_PROCESS_FN(task_memory_used)
+{
+    for (unsigned int _i = 0; _i < OS_TASK_MAX_ID; ++_i) {
+        struct task_control_block *_tcb = os_task_get_by_id(_i);
+        if (NULL != _tcb)
+            os_printk(":%-16s->%d\r\n", _tcb->_task_name, _tcb->_heap_bytes);
+    }
+    return 0;
+}
+
+OS_CMD_EXPORT(mtask, task_memory_used, "List the heap bytes held by each thread.");
+
+#endif
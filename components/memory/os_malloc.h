@@ -2,26 +2,102 @@
 #ifndef _OS_MALLOC_H_
 #define _OS_MALLOC_H_
 
+#include "../../os_def.h"
+
 /** 
  * The minimum memory size required to construct 
  * the kernel-recognizable memory data structure for the os_malloc_keep() function. 
  */
 #define OS_MALLOC_MIN_KEEP_SIZE   (1024)
+
+/**
+ * Heap region capabilities, see os_heap_region_add() and os_malloc_caps().
+ */
+#define OS_MALLOC_CAP_DEFAULT  (0)
+// Tightly coupled or zero-wait-state memory for hot data.
+#define OS_MALLOC_CAP_FAST     (1U << 0)
+// Memory reachable by the DMA controllers.
+#define OS_MALLOC_CAP_DMA      (1U << 1)
+// Memory behind the data cache.
+#define OS_MALLOC_CAP_CACHED   (1U << 2)
+// Large, slow memory such as external SDRAM for bulk buffers.
+#define OS_MALLOC_CAP_EXTERNAL (1U << 3)
+
+// Allocation size histogram buckets: <=16, <=32, ... <=1024 and >1024 bytes.
+#define OS_MALLOC_HIST_NUM     (8)
+
+/**
+ * A snapshot of a heap, see os_malloc_get_stats(). Sizes include the block
+ * headers except largest_free, which is the payload of the largest free block.
+ */
+struct os_heap_stats {
+    unsigned int total_size;
+    unsigned int used_size;
+    // high-water mark of used_size
+    unsigned int peak_size;
+    // live blocks
+    unsigned int alloc_num;
+    unsigned int free_num;
+    unsigned int largest_free;
+    // requests since the heap was created, by size
+    unsigned int hist[OS_MALLOC_HIST_NUM];
+    // bad blocks found by CONFIG_OS_MALLOC_DEBUG checks
+    unsigned int corrupt_num;
+};
+
+/**
+ * Per-task cache of blocks freed by os_free_safe(), kept for the task's next
+ * os_malloc_safe(). Size classes are 16, 32, 64 and 128 bytes.
+ */
+#define OS_MALLOC_CACHE_CLASS_NUM (4)
+#define OS_MALLOC_CACHE_CLASS_MIN (16)
+
+struct os_malloc_cache {
+    void *_head[OS_MALLOC_CACHE_CLASS_NUM];
+    unsigned char _num[OS_MALLOC_CACHE_CLASS_NUM];
+};
+
 typedef unsigned int OS_MALLOC_HANDLE;
 void os_memory_init(void);
 void* os_malloc(unsigned int _size);
 void *os_calloc(unsigned int _nmemb, unsigned int _size);
 void os_free(void* _ptr);
+void *os_realloc(void *_ptr, unsigned int _size);
 void* os_malloc_safe(unsigned int _size);
 void *os_calloc_safe(unsigned int _nmemb, unsigned int _size);
 void os_free_safe(void* _ptr);
+void *os_realloc_safe(void *_ptr, unsigned int _size);
 
 void* os_kmalloc(unsigned int _size);
 void *os_kcalloc(unsigned int _nmemb, unsigned int _size);
 void os_kfree(void* _ptr);
+void *os_krealloc(void *_ptr, unsigned int _size);
+void *os_malloc_isr(unsigned int _size);
+void os_free_isr(void *_ptr);
+
+void os_malloc_cache_init(struct os_malloc_cache *_cache);
+bool os_malloc_cache_flush(void);
 
 OS_MALLOC_HANDLE os_malloc_keep(void* _m_head, unsigned int _size);
 void* os_malloc_usr(OS_MALLOC_HANDLE _handle, unsigned int _size);
 void os_free_usr(OS_MALLOC_HANDLE _handle, void* _ptr);
 
+os_handle_state_t os_heap_region_add(void *_m_head, unsigned int _size, unsigned int _caps);
+void *os_malloc_caps(unsigned int _size, unsigned int _caps);
+void *os_malloc_aligned(unsigned int _size, unsigned int _align);
+void *os_malloc_dma(unsigned int _size);
+
+os_handle_state_t os_malloc_get_stats(OS_MALLOC_HANDLE _handle, struct os_heap_stats *_stats);
+os_handle_state_t os_malloc_stats(struct os_heap_stats *_stats);
+os_handle_state_t os_kmalloc_stats(struct os_heap_stats *_stats);
+
+#ifdef CONFIG_OS_MALLOC_DEBUG
+struct task_control_block;
+unsigned int os_malloc_verify(OS_MALLOC_HANDLE _handle, unsigned int _budget);
+unsigned int os_malloc_verify_all(unsigned int _budget);
+os_handle_state_t os_malloc_verifier_create(struct task_control_block *_tcb,
+                                            unsigned int *_stack, unsigned int _stack_size,
+                                            unsigned char _prio);
+#endif
+
 #endif
@@ -0,0 +1,128 @@
+/***********************
+ * @file: os_mempool.c
+ * @author: Feijie Luo
+ * @Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     Feijie Luo   First version
+ * @note:
+ ***********************/
+
+#include "../../board/libcpu_headfile.h"
+#include "../../os_def.h"
+#include "os_mempool.h"
+
+#include "stddef.h"
+
+#define MEMPOOL_INDEX_MASK (0xFFFFU)
+#define MEMPOOL_TAG_ONE    (0x10000U)
+
+os_private inline unsigned int *__os_mempool_blk(struct os_mempool *_pool, unsigned int _index)
+{
+    return (unsigned int *)(_pool->_buf + _index * _pool->_blk_size);
+}
+
+/**
+ * Initialize a pool on a caller-provided buffer.
+ *
+ * @param[in/out] _pool     The pool to be initialized.
+ * @param[in]     _buf      The block storage, must be 4 bytes aligned.
+ * @param[in]     _buf_size The size of _buf in bytes.
+ * @param[in]     _blk_size The size of an object, rounded up by OS_MEMPOOL_BLK_SIZE.
+ *
+ * @return OS_HANDLE_FAIL if no block fits in _buf.
+ */
+os_handle_state_t os_mempool_init(struct os_mempool *_pool, void *_buf,
+                                  unsigned int _buf_size, unsigned int _blk_size)
+{
+    if (NULL == _pool ||
+        NULL == _buf ||
+        ((unsigned int)_buf & 3) ||
+        0 == _blk_size)
+        return OS_HANDLE_FAIL;
+    _blk_size = OS_MEMPOOL_BLK_SIZE(_blk_size);
+    if (_buf_size < _blk_size)
+        return OS_HANDLE_FAIL;
+    _pool->_buf = (unsigned char *)_buf;
+    _pool->_blk_size = _blk_size;
+    _pool->_blk_num = _buf_size / _blk_size;
+    if (_pool->_blk_num > OS_MEMPOOL_MAX_BLK_NUM)
+        _pool->_blk_num = OS_MEMPOOL_MAX_BLK_NUM;
+    _pool->_free = 0;
+    _pool->_watermark = 0;
+    _pool->_num_used = 0;
+    return OS_HANDLE_SUCCESS;
+}
+
+/**
+ * Take a block from the pool in O(1). **ISR-safe**
+ *
+ * @return A pointer to the block, NULL if the pool is exhausted.
+ */
+void *os_mempool_alloc(struct os_mempool *_pool)
+{
+    if (NULL == _pool)
+        return NULL;
+
+    // Reuse a freed block first. The tag makes the CAS fail if the head was
+    // popped and pushed back in between, so a stale _next is never installed.
+    os_base_t _old = os_atomic_load(&_pool->_free);
+    while (_old & MEMPOOL_INDEX_MASK) {
+        unsigned int _index = ((unsigned int)_old & MEMPOOL_INDEX_MASK) - 1;
+        unsigned int _next = *__os_mempool_blk(_pool, _index);
+        os_base_t _new = (os_base_t)((((unsigned int)_old + MEMPOOL_TAG_ONE) & ~MEMPOOL_INDEX_MASK) |
+                                     (_next & MEMPOOL_INDEX_MASK));
+        if (os_atomic_compare_exchange_strong(&_pool->_free, &_old, _new)) {
+            os_atomic_add(&_pool->_num_used, 1);
+            return (void *)__os_mempool_blk(_pool, _index);
+        }
+    }
+
+    // Then hand out a block that was never used.
+    os_base_t _mark = os_atomic_load(&_pool->_watermark);
+    while ((unsigned int)_mark < _pool->_blk_num) {
+        if (os_atomic_compare_exchange_strong(&_pool->_watermark, &_mark, _mark + 1)) {
+            os_atomic_add(&_pool->_num_used, 1);
+            return (void *)__os_mempool_blk(_pool, (unsigned int)_mark);
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Return a block [MUST BE] taken from the same pool in O(1). **ISR-safe**
+ */
+void os_mempool_free(struct os_mempool *_pool, void *_blk)
+{
+    if (NULL == _pool || NULL == _blk)
+        return;
+    OS_ASSERT(os_mempool_owns(_pool, _blk));
+
+    unsigned int _index = (unsigned int)((unsigned char *)_blk - _pool->_buf) / _pool->_blk_size;
+    os_base_t _old = os_atomic_load(&_pool->_free);
+    os_base_t _new;
+    do {
+        *(unsigned int *)_blk = (unsigned int)_old & MEMPOOL_INDEX_MASK;
+        _new = (os_base_t)((((unsigned int)_old + MEMPOOL_TAG_ONE) & ~MEMPOOL_INDEX_MASK) | (_index + 1));
+    } while (!os_atomic_compare_exchange_strong(&_pool->_free, &_old, _new));
+    os_atomic_sub(&_pool->_num_used, 1);
+}
+
+/**
+ * Whether _blk points at a block of the pool.
+ */
+bool os_mempool_owns(struct os_mempool *_pool, const void *_blk)
+{
+    const unsigned char *_p = (const unsigned char *)_blk;
+
+    if (NULL == _pool || _p < _pool->_buf)
+        return false;
+    unsigned int _off = (unsigned int)(_p - _pool->_buf);
+    return (_off < _pool->_blk_num * _pool->_blk_size) && (0 == _off % _pool->_blk_size);
+}
+
+unsigned int os_mempool_used(struct os_mempool *_pool)
+{
+    if (NULL == _pool)
+        return 0;
+    return (unsigned int)os_atomic_load(&_pool->_num_used);
+}
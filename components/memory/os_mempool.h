@@ -0,0 +1,66 @@
+/***********************
+ * @file: os_mempool.h
+ * @author: Feijie Luo
+ * @Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     Feijie Luo   First version
+ * @note:
+ ***********************/
+
+#ifndef _OS_MEMPOOL_H_
+#define _OS_MEMPOOL_H_
+
+#include "../../os_def.h"
+
+/**
+ * Block size rounded up to hold the free-list link and keep blocks 4 bytes aligned.
+ */
+#define OS_MEMPOOL_BLK_SIZE(_size) \
+    (((_size) < sizeof(unsigned int)) ? sizeof(unsigned int) : (((_size) + 3U) & ~3U))
+#define OS_MEMPOOL_BUF_SIZE(_size, _num) (OS_MEMPOOL_BLK_SIZE(_size) * (_num))
+// The free-list head packs a 16-bit block index with a 16-bit ABA tag.
+#define OS_MEMPOOL_MAX_BLK_NUM (0xFFFEU)
+
+/**
+ * Fixed-size block pool. Alloc and free are O(1) and lock-free, so they can
+ * be called from tasks and interrupts alike.
+ *
+ * Blocks that were never allocated are handed out in address order first,
+ * so a pool needs no initialisation pass and can be defined statically.
+ */
+struct os_mempool {
+    unsigned char *_buf;
+    unsigned int _blk_size;
+    unsigned int _blk_num;
+    // (tag << 16) | (index + 1) of the first free block, index 0 means empty
+    volatile os_base_t _free;
+    // Number of blocks ever handed out
+    volatile os_base_t _watermark;
+    volatile os_base_t _num_used;
+};
+
+#define OS_MEMPOOL_INIT(_pool_buf, _size, _num)            \
+    {                                                      \
+        ._buf = (unsigned char *)(_pool_buf),              \
+        ._blk_size = OS_MEMPOOL_BLK_SIZE(_size),           \
+        ._blk_num = (_num),                                \
+        ._free = 0,                                        \
+        ._watermark = 0,                                   \
+        ._num_used = 0,                                    \
+    }
+
+/**
+ * Define a static pool named _name holding _num objects of _type.
+ */
+#define OS_MEMPOOL_DEFINE(_name, _type, _num)                                                         \
+    static unsigned int __##_name##_buf[OS_MEMPOOL_BUF_SIZE(sizeof(_type), _num) / sizeof(unsigned int)]; \
+    static struct os_mempool _name = OS_MEMPOOL_INIT(__##_name##_buf, sizeof(_type), _num)
+
+os_handle_state_t os_mempool_init(struct os_mempool *_pool, void *_buf,
+                                  unsigned int _buf_size, unsigned int _blk_size);
+void *os_mempool_alloc(struct os_mempool *_pool);
+void os_mempool_free(struct os_mempool *_pool, void *_blk);
+bool os_mempool_owns(struct os_mempool *_pool, const void *_blk);
+unsigned int os_mempool_used(struct os_mempool *_pool);
+
+#endif
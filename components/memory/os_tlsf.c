@@ -0,0 +1,659 @@
+/***********************
+ * @file: os_tlsf.c
+ * @author: Feijie Luo
+ * @Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     Feijie Luo   First version
+ * 2026-10-19     Feijie Luo   Add aligned allocation
+ * 2026-10-19     Feijie Luo   Add in-place resize
+ * 2026-10-19     Feijie Luo   Count free blocks, add os_tlsf_free_info
+ * 2026-10-19     Feijie Luo   Add block walk and boundary tag checks
+ * @note:
+ ***********************/
+
+#include "../../os_config.h"
+#include "../../os_def.h"
+#include "../../os_sched.h"
+#include "os_tlsf.h"
+
+#include "stddef.h"
+
+#ifndef CONFIG_OS_TLSF_FL_INDEX_MAX
+#define CONFIG_OS_TLSF_FL_INDEX_MAX (20)
+#endif
+
+#define TLSF_ALIGN_LOG2  (2)
+#define TLSF_ALIGN_SIZE  (1U << TLSF_ALIGN_LOG2)
+// log2 of the number of second-level lists per first-level class
+#define TLSF_SL_LOG2     (3)
+#define TLSF_SL_COUNT    (1U << TLSF_SL_LOG2)
+#define TLSF_FL_SHIFT    (TLSF_SL_LOG2 + TLSF_ALIGN_LOG2)
+#define TLSF_FL_COUNT    (CONFIG_OS_TLSF_FL_INDEX_MAX - TLSF_FL_SHIFT + 1)
+// blocks below this size are linearly mapped into the first class
+#define TLSF_SMALL_BLOCK (1U << TLSF_FL_SHIFT)
+
+#define TLSF_BLOCK_FREE      (1U << 0)
+#define TLSF_BLOCK_PREV_FREE (1U << 1)
+#define TLSF_BLOCK_FLAGS     (TLSF_BLOCK_FREE | TLSF_BLOCK_PREV_FREE)
+
+struct tlsf_block {
+    // Only valid when the previous physical block is free, it overlaps the
+    // tail of the previous block's payload otherwise.
+    struct tlsf_block *_prev_phys;
+    // Payload size in bytes, the low bits hold TLSF_BLOCK_* flags.
+    unsigned int _size;
+    // Only valid when this block is free.
+    struct tlsf_block *_next_free;
+    struct tlsf_block *_prev_free;
+};
+
+// The only header word a used block pays for.
+#define TLSF_BLOCK_OVERHEAD     (sizeof(unsigned int))
+#define TLSF_BLOCK_START_OFFSET (sizeof(struct tlsf_block *) + sizeof(unsigned int))
+#define TLSF_BLOCK_SIZE_MIN     (sizeof(struct tlsf_block) - sizeof(struct tlsf_block *))
+#define TLSF_BLOCK_SIZE_MAX     (1U << CONFIG_OS_TLSF_FL_INDEX_MAX)
+
+struct tlsf_control {
+    // Empty lists point here instead of NULL.
+    struct tlsf_block _null;
+    unsigned int _fl_bitmap;
+    unsigned char _sl_bitmap[TLSF_FL_COUNT];
+    struct tlsf_block *_blocks[TLSF_FL_COUNT][TLSF_SL_COUNT];
+    unsigned int _used;
+    unsigned int _free_num;
+    // The zero-sized sentinel that ends the pool.
+    struct tlsf_block *_tail;
+};
+
+#if (CONFIG_OS_TLSF_FL_INDEX_MAX > 30) || (CONFIG_OS_TLSF_FL_INDEX_MAX <= TLSF_FL_SHIFT)
+#error "CONFIG_OS_TLSF_FL_INDEX_MAX out of range"
+#endif
+
+/**
+ * Index of the highest set bit, _word must not be 0.
+ */
+os_private inline unsigned int __os_tlsf_fls(unsigned int _word)
+{
+    unsigned int _bit = 0;
+
+    if (_word & 0xFFFF0000) {
+        _word >>= 16;
+        _bit += 16;
+    }
+    if (_word & 0xFF00) {
+        _word >>= 8;
+        _bit += 8;
+    }
+    if (_word & 0xF0) {
+        _word >>= 4;
+        _bit += 4;
+    }
+    if (_word & 0xC) {
+        _word >>= 2;
+        _bit += 2;
+    }
+    if (_word & 0x2)
+        _bit += 1;
+    return _bit;
+}
+
+os_private inline unsigned int __os_tlsf_block_size(const struct tlsf_block *_b)
+{
+    return _b->_size & ~TLSF_BLOCK_FLAGS;
+}
+
+os_private inline void __os_tlsf_block_set_size(struct tlsf_block *_b, unsigned int _size)
+{
+    _b->_size = _size | (_b->_size & TLSF_BLOCK_FLAGS);
+}
+
+os_private inline bool __os_tlsf_block_is_free(const struct tlsf_block *_b)
+{
+    return (_b->_size & TLSF_BLOCK_FREE) != 0;
+}
+
+os_private inline bool __os_tlsf_block_prev_is_free(const struct tlsf_block *_b)
+{
+    return (_b->_size & TLSF_BLOCK_PREV_FREE) != 0;
+}
+
+os_private inline struct tlsf_block *__os_tlsf_block_from_ptr(const void *_ptr)
+{
+    return (struct tlsf_block *)((unsigned char *)_ptr - TLSF_BLOCK_START_OFFSET);
+}
+
+os_private inline void *__os_tlsf_block_to_ptr(const struct tlsf_block *_b)
+{
+    return (void *)((unsigned char *)_b + TLSF_BLOCK_START_OFFSET);
+}
+
+os_private inline struct tlsf_block *__os_tlsf_block_next(const struct tlsf_block *_b)
+{
+    return (struct tlsf_block *)((unsigned char *)__os_tlsf_block_to_ptr(_b) +
+                                 __os_tlsf_block_size(_b) - TLSF_BLOCK_OVERHEAD);
+}
+
+/**
+ * Link the next physical block back to _b and return it.
+ */
+os_private inline struct tlsf_block *__os_tlsf_block_link_next(struct tlsf_block *_b)
+{
+    struct tlsf_block *_next = __os_tlsf_block_next(_b);
+    _next->_prev_phys = _b;
+    return _next;
+}
+
+os_private inline void __os_tlsf_block_mark_free(struct tlsf_block *_b)
+{
+    struct tlsf_block *_next = __os_tlsf_block_link_next(_b);
+    _next->_size |= TLSF_BLOCK_PREV_FREE;
+    _b->_size |= TLSF_BLOCK_FREE;
+}
+
+os_private inline void __os_tlsf_block_mark_used(struct tlsf_block *_b)
+{
+    struct tlsf_block *_next = __os_tlsf_block_next(_b);
+    _next->_size &= ~TLSF_BLOCK_PREV_FREE;
+    _b->_size &= ~TLSF_BLOCK_FREE;
+}
+
+/**
+ * Round a request up to the alignment and the minimum block size.
+ *
+ * @return 0 if the request can never be satisfied.
+ */
+os_private inline unsigned int __os_tlsf_adjust_size(unsigned int _size)
+{
+    if (0 == _size || _size >= TLSF_BLOCK_SIZE_MAX)
+        return 0;
+    _size = (_size + (TLSF_ALIGN_SIZE - 1)) & ~(TLSF_ALIGN_SIZE - 1);
+    return _size < TLSF_BLOCK_SIZE_MIN ? TLSF_BLOCK_SIZE_MIN : _size;
+}
+
+/**
+ * Map a block size to the list it is stored in.
+ */
+os_private inline void __os_tlsf_mapping_insert(unsigned int _size, unsigned int *_fl, unsigned int *_sl)
+{
+    if (_size < TLSF_SMALL_BLOCK) {
+        *_fl = 0;
+        *_sl = _size / (TLSF_SMALL_BLOCK / TLSF_SL_COUNT);
+    } else {
+        unsigned int _bit = __os_tlsf_fls(_size);
+        *_sl = (_size >> (_bit - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+        *_fl = _bit - (TLSF_FL_SHIFT - 1);
+    }
+}
+
+/**
+ * Map a request to the first list whose blocks are all large enough.
+ */
+os_private inline void __os_tlsf_mapping_search(unsigned int _size, unsigned int *_fl, unsigned int *_sl)
+{
+    if (_size >= TLSF_SMALL_BLOCK)
+        _size += (1U << (__os_tlsf_fls(_size) - TLSF_SL_LOG2)) - 1;
+    __os_tlsf_mapping_insert(_size, _fl, _sl);
+}
+
+os_private struct tlsf_block *__os_tlsf_search_suitable(struct tlsf_control *_ctrl,
+                                                        unsigned int *_fl, unsigned int *_sl)
+{
+    unsigned int _sl_map = _ctrl->_sl_bitmap[*_fl] & (~0U << *_sl);
+
+    if (0 == _sl_map) {
+        unsigned int _fl_map = _ctrl->_fl_bitmap & (~0U << (*_fl + 1));
+        if (0 == _fl_map)
+            return NULL;
+        *_fl = os_ffb(_fl_map);
+        _sl_map = _ctrl->_sl_bitmap[*_fl];
+    }
+    *_sl = os_ffb(_sl_map);
+    return _ctrl->_blocks[*_fl][*_sl];
+}
+
+os_private void __os_tlsf_remove_free(struct tlsf_control *_ctrl, struct tlsf_block *_b,
+                                      unsigned int _fl, unsigned int _sl)
+{
+    struct tlsf_block *_prev = _b->_prev_free;
+    struct tlsf_block *_next = _b->_next_free;
+
+    _next->_prev_free = _prev;
+    _prev->_next_free = _next;
+    _ctrl->_free_num--;
+    if (_ctrl->_blocks[_fl][_sl] == _b) {
+        _ctrl->_blocks[_fl][_sl] = _next;
+        if (_next == &_ctrl->_null) {
+            _ctrl->_sl_bitmap[_fl] &= ~(1U << _sl);
+            if (0 == _ctrl->_sl_bitmap[_fl])
+                _ctrl->_fl_bitmap &= ~(1U << _fl);
+        }
+    }
+}
+
+os_private void __os_tlsf_insert_free(struct tlsf_control *_ctrl, struct tlsf_block *_b,
+                                      unsigned int _fl, unsigned int _sl)
+{
+    struct tlsf_block *_cur = _ctrl->_blocks[_fl][_sl];
+
+    _b->_next_free = _cur;
+    _b->_prev_free = &_ctrl->_null;
+    _cur->_prev_free = _b;
+    _ctrl->_blocks[_fl][_sl] = _b;
+    _ctrl->_free_num++;
+    _ctrl->_fl_bitmap |= (1U << _fl);
+    _ctrl->_sl_bitmap[_fl] |= (1U << _sl);
+}
+
+os_private inline void __os_tlsf_block_remove(struct tlsf_control *_ctrl, struct tlsf_block *_b)
+{
+    unsigned int _fl, _sl;
+    __os_tlsf_mapping_insert(__os_tlsf_block_size(_b), &_fl, &_sl);
+    __os_tlsf_remove_free(_ctrl, _b, _fl, _sl);
+}
+
+os_private inline void __os_tlsf_block_insert(struct tlsf_control *_ctrl, struct tlsf_block *_b)
+{
+    unsigned int _fl, _sl;
+    __os_tlsf_mapping_insert(__os_tlsf_block_size(_b), &_fl, &_sl);
+    __os_tlsf_insert_free(_ctrl, _b, _fl, _sl);
+}
+
+/**
+ * Split _b at _size and return the free remainder.
+ */
+os_private struct tlsf_block *__os_tlsf_block_split(struct tlsf_block *_b, unsigned int _size)
+{
+    struct tlsf_block *_rest =
+        (struct tlsf_block *)((unsigned char *)__os_tlsf_block_to_ptr(_b) + _size - TLSF_BLOCK_OVERHEAD);
+    unsigned int _rest_size = __os_tlsf_block_size(_b) - (_size + TLSF_BLOCK_OVERHEAD);
+
+    _rest->_size = _rest_size;
+    __os_tlsf_block_set_size(_b, _size);
+    __os_tlsf_block_mark_free(_rest);
+    return _rest;
+}
+
+/**
+ * Merge _b into its physical predecessor _prev.
+ */
+os_private inline struct tlsf_block *__os_tlsf_block_absorb(struct tlsf_block *_prev, struct tlsf_block *_b)
+{
+    _prev->_size += __os_tlsf_block_size(_b) + TLSF_BLOCK_OVERHEAD;
+    __os_tlsf_block_link_next(_prev);
+    return _prev;
+}
+
+os_private struct tlsf_block *__os_tlsf_merge_prev(struct tlsf_control *_ctrl, struct tlsf_block *_b)
+{
+    if (__os_tlsf_block_prev_is_free(_b)) {
+        struct tlsf_block *_prev = _b->_prev_phys;
+        __os_tlsf_block_remove(_ctrl, _prev);
+        _b = __os_tlsf_block_absorb(_prev, _b);
+    }
+    return _b;
+}
+
+os_private struct tlsf_block *__os_tlsf_merge_next(struct tlsf_control *_ctrl, struct tlsf_block *_b)
+{
+    struct tlsf_block *_next = __os_tlsf_block_next(_b);
+
+    if (__os_tlsf_block_is_free(_next)) {
+        __os_tlsf_block_remove(_ctrl, _next);
+        _b = __os_tlsf_block_absorb(_b, _next);
+    }
+    return _b;
+}
+
+/**
+ * Return the tail of a free block beyond _size to the pool.
+ */
+os_private void __os_tlsf_trim_free(struct tlsf_control *_ctrl, struct tlsf_block *_b, unsigned int _size)
+{
+    if (__os_tlsf_block_size(_b) >= sizeof(struct tlsf_block) + _size) {
+        struct tlsf_block *_rest = __os_tlsf_block_split(_b, _size);
+        __os_tlsf_block_link_next(_b);
+        _rest->_size |= TLSF_BLOCK_PREV_FREE;
+        __os_tlsf_block_insert(_ctrl, _rest);
+    }
+}
+
+/**
+ * Trim a block taken off the free lists to _size and mark it used.
+ */
+os_private void *__os_tlsf_prepare_used(struct tlsf_control *_ctrl, struct tlsf_block *_b, unsigned int _size)
+{
+    __os_tlsf_trim_free(_ctrl, _b, _size);
+    __os_tlsf_block_mark_used(_b);
+    _ctrl->_used += __os_tlsf_block_size(_b) + TLSF_BLOCK_OVERHEAD;
+    return __os_tlsf_block_to_ptr(_b);
+}
+
+/**
+ * Create a TLSF allocator on the memory block [_mem, _mem + _size).
+ *
+ * @param[in/out] _mem  The start of the memory, must be 4 bytes aligned.
+ * @param[in]     _size The size of the memory, including the control structure.
+ *
+ * @return The allocator handle, NULL if the memory is misaligned, too small
+ *         or larger than 1 << CONFIG_OS_TLSF_FL_INDEX_MAX.
+ */
+OS_TLSF_HANDLE os_tlsf_create(void *_mem, unsigned int _size)
+{
+    struct tlsf_control *_ctrl = (struct tlsf_control *)_mem;
+    unsigned int _pool_size;
+
+    if (NULL == _mem ||
+        ((unsigned int)_mem & (TLSF_ALIGN_SIZE - 1)) ||
+        _size < sizeof(struct tlsf_control) + 2 * TLSF_BLOCK_OVERHEAD + TLSF_BLOCK_SIZE_MIN)
+        return NULL;
+    _pool_size = (_size - sizeof(struct tlsf_control) - 2 * TLSF_BLOCK_OVERHEAD) & ~(TLSF_ALIGN_SIZE - 1);
+    if (_pool_size >= TLSF_BLOCK_SIZE_MAX)
+        return NULL;
+
+    _ctrl->_null._next_free = &_ctrl->_null;
+    _ctrl->_null._prev_free = &_ctrl->_null;
+    _ctrl->_fl_bitmap = 0;
+    _ctrl->_used = 0;
+    _ctrl->_free_num = 0;
+    for (unsigned int _i = 0; _i < TLSF_FL_COUNT; ++_i) {
+        _ctrl->_sl_bitmap[_i] = 0;
+        for (unsigned int _j = 0; _j < TLSF_SL_COUNT; ++_j)
+            _ctrl->_blocks[_i][_j] = &_ctrl->_null;
+    }
+
+    // The first block's _prev_phys lies in the control structure and is never used.
+    struct tlsf_block *_b = (struct tlsf_block *)((unsigned char *)(_ctrl + 1) - TLSF_BLOCK_OVERHEAD);
+    _b->_size = _pool_size | TLSF_BLOCK_FREE;
+    __os_tlsf_block_insert(_ctrl, _b);
+
+    // A zero-sized used sentinel ends the pool so merges never run past it.
+    struct tlsf_block *_tail = __os_tlsf_block_link_next(_b);
+    _tail->_size = TLSF_BLOCK_PREV_FREE;
+    _ctrl->_tail = _tail;
+    return (OS_TLSF_HANDLE)_ctrl;
+}
+
+/**
+ * Allocate memory from a TLSF allocator in O(1). **Non-thread-safe**
+ *
+ * @param[in] _tlsf The return value of os_tlsf_create(...).
+ * @param[in] _size The size of the memory block to be allocated.
+ *
+ * @return A pointer to the allocated memory block, NULL if none is large enough.
+ */
+void *os_tlsf_malloc(OS_TLSF_HANDLE _tlsf, unsigned int _size)
+{
+    struct tlsf_control *_ctrl = (struct tlsf_control *)_tlsf;
+    unsigned int _fl, _sl;
+    struct tlsf_block *_b;
+
+    if (NULL == _ctrl)
+        return NULL;
+    _size = __os_tlsf_adjust_size(_size);
+    if (0 == _size)
+        return NULL;
+    __os_tlsf_mapping_search(_size, &_fl, &_sl);
+    if (_fl >= TLSF_FL_COUNT)
+        return NULL;
+    _b = __os_tlsf_search_suitable(_ctrl, &_fl, &_sl);
+    if (NULL == _b || _b == &_ctrl->_null)
+        return NULL;
+
+    __os_tlsf_remove_free(_ctrl, _b, _fl, _sl);
+    return __os_tlsf_prepare_used(_ctrl, _b, _size);
+}
+
+/**
+ * Allocate memory whose address is a multiple of _align in O(1). **Non-thread-safe**
+ *
+ * @param[in] _tlsf  The return value of os_tlsf_create(...).
+ * @param[in] _size  The size of the memory block to be allocated.
+ * @param[in] _align The alignment, a power of 2.
+ *
+ * @return A pointer to the allocated memory block, freed by os_tlsf_free(...).
+ */
+void *os_tlsf_malloc_aligned(OS_TLSF_HANDLE _tlsf, unsigned int _size, unsigned int _align)
+{
+    struct tlsf_control *_ctrl = (struct tlsf_control *)_tlsf;
+    unsigned int _fl, _sl;
+    struct tlsf_block *_b;
+
+    if (NULL == _ctrl ||
+        0 == _align ||
+        (_align & (_align - 1)) ||
+        _align >= TLSF_BLOCK_SIZE_MAX / 2)
+        return NULL;
+    if (_align <= TLSF_ALIGN_SIZE)
+        return os_tlsf_malloc(_tlsf, _size);
+    _size = __os_tlsf_adjust_size(_size);
+    if (0 == _size || _size >= TLSF_BLOCK_SIZE_MAX - _align - sizeof(struct tlsf_block))
+        return NULL;
+
+    // Leave room for a leading gap, which must be able to hold a free block.
+    __os_tlsf_mapping_search(__os_tlsf_adjust_size(_size + _align + sizeof(struct tlsf_block)), &_fl, &_sl);
+    if (_fl >= TLSF_FL_COUNT)
+        return NULL;
+    _b = __os_tlsf_search_suitable(_ctrl, &_fl, &_sl);
+    if (NULL == _b || _b == &_ctrl->_null)
+        return NULL;
+    __os_tlsf_remove_free(_ctrl, _b, _fl, _sl);
+
+    unsigned int _ptr = (unsigned int)__os_tlsf_block_to_ptr(_b);
+    unsigned int _gap = ((_ptr + _align - 1) & ~(_align - 1)) - _ptr;
+    if (0 != _gap && _gap < sizeof(struct tlsf_block))
+        _gap = ((_ptr + sizeof(struct tlsf_block) + _align - 1) & ~(_align - 1)) - _ptr;
+    if (0 != _gap) {
+        // Return the leading gap to the pool as a free block.
+        struct tlsf_block *_rest = __os_tlsf_block_split(_b, _gap - TLSF_BLOCK_OVERHEAD);
+        _rest->_size |= TLSF_BLOCK_PREV_FREE;
+        __os_tlsf_block_link_next(_b);
+        __os_tlsf_block_insert(_ctrl, _b);
+        _b = _rest;
+    }
+    return __os_tlsf_prepare_used(_ctrl, _b, _size);
+}
+
+/**
+ * Free memory [MUST BE] allocated by os_tlsf_malloc in O(1). **Non-thread-safe**
+ *
+ * @param[in]     _tlsf The return value of os_tlsf_create(...).
+ * @param[in/out] _ptr  A pointer to the memory block to be freed.
+ */
+void os_tlsf_free(OS_TLSF_HANDLE _tlsf, void *_ptr)
+{
+    struct tlsf_control *_ctrl = (struct tlsf_control *)_tlsf;
+    struct tlsf_block *_b;
+
+    if (NULL == _ctrl || NULL == _ptr)
+        return;
+    _b = __os_tlsf_block_from_ptr(_ptr);
+    OS_ASSERT(!__os_tlsf_block_is_free(_b));
+    _ctrl->_used -= __os_tlsf_block_size(_b) + TLSF_BLOCK_OVERHEAD;
+    __os_tlsf_block_mark_free(_b);
+    _b = __os_tlsf_merge_prev(_ctrl, _b);
+    _b = __os_tlsf_merge_next(_ctrl, _b);
+    __os_tlsf_block_insert(_ctrl, _b);
+}
+
+/**
+ * Resize an allocated block in place in O(1), growing into the next physical
+ * block when it is free and returning any excess to the pool. **Non-thread-safe**
+ *
+ * @param[in]     _tlsf The return value of os_tlsf_create(...).
+ * @param[in/out] _ptr  A pointer to an allocated memory block.
+ * @param[in]     _size The new size.
+ *
+ * @return OS_HANDLE_FAIL if the block cannot grow in place, it is left unchanged.
+ */
+os_handle_state_t os_tlsf_resize(OS_TLSF_HANDLE _tlsf, void *_ptr, unsigned int _size)
+{
+    struct tlsf_control *_ctrl = (struct tlsf_control *)_tlsf;
+    struct tlsf_block *_b;
+    unsigned int _old_size;
+
+    if (NULL == _ctrl || NULL == _ptr)
+        return OS_HANDLE_FAIL;
+    _size = __os_tlsf_adjust_size(_size);
+    if (0 == _size)
+        return OS_HANDLE_FAIL;
+    _b = __os_tlsf_block_from_ptr(_ptr);
+    _old_size = __os_tlsf_block_size(_b);
+
+    if (_size > _old_size) {
+        struct tlsf_block *_next = __os_tlsf_block_next(_b);
+        if (!__os_tlsf_block_is_free(_next) ||
+            _old_size + __os_tlsf_block_size(_next) + TLSF_BLOCK_OVERHEAD < _size)
+            return OS_HANDLE_FAIL;
+        __os_tlsf_block_remove(_ctrl, _next);
+        __os_tlsf_block_absorb(_b, _next);
+        __os_tlsf_block_mark_used(_b);
+    }
+
+    // Give the excess back, merged with a free successor.
+    if (__os_tlsf_block_size(_b) >= sizeof(struct tlsf_block) + _size) {
+        struct tlsf_block *_rest = __os_tlsf_block_split(_b, _size);
+        _rest = __os_tlsf_merge_next(_ctrl, _rest);
+        __os_tlsf_block_insert(_ctrl, _rest);
+    }
+    _ctrl->_used += __os_tlsf_block_size(_b);
+    _ctrl->_used -= _old_size;
+    return OS_HANDLE_SUCCESS;
+}
+
+/**
+ * The usable size of an allocated block, at least the requested size.
+ */
+unsigned int os_tlsf_block_size(void *_ptr)
+{
+    if (NULL == _ptr)
+        return 0;
+    return __os_tlsf_block_size(__os_tlsf_block_from_ptr(_ptr));
+}
+
+os_private inline struct tlsf_block *__os_tlsf_first_block(const struct tlsf_control *_ctrl)
+{
+    return (struct tlsf_block *)((unsigned char *)(_ctrl + 1) - TLSF_BLOCK_OVERHEAD);
+}
+
+os_private inline bool __os_tlsf_in_pool(const struct tlsf_control *_ctrl, const struct tlsf_block *_b)
+{
+    return _b >= __os_tlsf_first_block(_ctrl) && _b < _ctrl->_tail &&
+           0 == ((unsigned int)_b & (TLSF_ALIGN_SIZE - 1));
+}
+
+os_private inline bool __os_tlsf_free_link_ok(const struct tlsf_control *_ctrl, const struct tlsf_block *_link)
+{
+    return _link == &_ctrl->_null || __os_tlsf_in_pool(_ctrl, _link);
+}
+
+bool os_tlsf_block_is_free(const void *_ptr)
+{
+    return __os_tlsf_block_is_free(__os_tlsf_block_from_ptr(_ptr));
+}
+
+/**
+ * Check the boundary tags of a block without trusting them: it must lie in
+ * the pool, and it and its next physical block must agree on whether it is
+ * free. A free block must also have used neighbours and sit in a free list.
+ *
+ * @param[in] _tlsf The return value of os_tlsf_create(...).
+ * @param[in] _ptr  The payload of the block, allocated or not.
+ *
+ * @return false if _ptr is not a sound block of this pool.
+ */
+bool os_tlsf_block_check(OS_TLSF_HANDLE _tlsf, const void *_ptr)
+{
+    struct tlsf_control *_ctrl = (struct tlsf_control *)_tlsf;
+    struct tlsf_block *_b, *_next;
+    unsigned int _size;
+
+    if (NULL == _ctrl || NULL == _ptr)
+        return false;
+    _b = __os_tlsf_block_from_ptr(_ptr);
+    if (!__os_tlsf_in_pool(_ctrl, _b))
+        return false;
+    // _b lies before the tail, so the distance covers at least the header.
+    _size = __os_tlsf_block_size(_b);
+    if (_size < TLSF_BLOCK_SIZE_MIN ||
+        _size > (unsigned int)((unsigned char *)_ctrl->_tail - (unsigned char *)_b) -
+                    (TLSF_BLOCK_START_OFFSET - TLSF_BLOCK_OVERHEAD))
+        return false;
+    _next = __os_tlsf_block_next(_b);
+    if (!__os_tlsf_block_is_free(_b))
+        return !__os_tlsf_block_prev_is_free(_next);
+    return __os_tlsf_block_prev_is_free(_next) &&
+           _next->_prev_phys == _b &&
+           !__os_tlsf_block_is_free(_next) &&
+           !__os_tlsf_block_prev_is_free(_b) &&
+           __os_tlsf_free_link_ok(_ctrl, _b->_next_free) &&
+           __os_tlsf_free_link_ok(_ctrl, _b->_prev_free) &&
+           (_b->_next_free == &_ctrl->_null || _b->_next_free->_prev_free == _b) &&
+           (_b->_prev_free == &_ctrl->_null || _b->_prev_free->_next_free == _b);
+}
+
+/**
+ * Step a walk over the pool in address order.
+ *
+ * @param[in] _tlsf The return value of os_tlsf_create(...).
+ * @param[in] _ptr  The block returned by the previous step, NULL to start.
+ *                  It should have passed os_tlsf_block_check(...).
+ *
+ * @return The payload of the next block, NULL at the end of the pool.
+ */
+void *os_tlsf_block_walk(OS_TLSF_HANDLE _tlsf, const void *_ptr)
+{
+    struct tlsf_control *_ctrl = (struct tlsf_control *)_tlsf;
+    struct tlsf_block *_b;
+
+    if (NULL == _ctrl)
+        return NULL;
+    _b = (NULL == _ptr) ? __os_tlsf_first_block(_ctrl) : __os_tlsf_block_next(__os_tlsf_block_from_ptr(_ptr));
+    if (_b == _ctrl->_tail)
+        return NULL;
+    return __os_tlsf_block_to_ptr(_b);
+}
+
+/**
+ * Bytes held by allocated blocks, including their headers.
+ */
+unsigned int os_tlsf_used(OS_TLSF_HANDLE _tlsf)
+{
+    if (NULL == _tlsf)
+        return 0;
+    return ((struct tlsf_control *)_tlsf)->_used;
+}
+
+/**
+ * The number of free blocks and the payload size of the largest one. The
+ * largest block lives in the highest non-empty size class, so only that one
+ * list is searched.
+ */
+void os_tlsf_free_info(OS_TLSF_HANDLE _tlsf, unsigned int *_free_num, unsigned int *_largest)
+{
+    struct tlsf_control *_ctrl = (struct tlsf_control *)_tlsf;
+    unsigned int _max = 0;
+
+    if (NULL == _tlsf)
+        return;
+    if (0 != _ctrl->_fl_bitmap) {
+        unsigned int _fl = __os_tlsf_fls(_ctrl->_fl_bitmap);
+        unsigned int _sl = __os_tlsf_fls(_ctrl->_sl_bitmap[_fl]);
+        for (struct tlsf_block *_b = _ctrl->_blocks[_fl][_sl]; _b != &_ctrl->_null; _b = _b->_next_free) {
+            if (__os_tlsf_block_size(_b) > _max)
+                _max = __os_tlsf_block_size(_b);
+        }
+    }
+    if (NULL != _free_num)
+        *_free_num = _ctrl->_free_num;
+    if (NULL != _largest)
+        *_largest = _max;
+}
+
+/**
+ * Bytes taken from the memory handed to os_tlsf_create(...) by the control
+ * structure and the pool boundary tags.
+ */
+unsigned int os_tlsf_overhead(void)
+{
+    return sizeof(struct tlsf_control) + 2 * TLSF_BLOCK_OVERHEAD;
+}
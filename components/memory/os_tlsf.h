@@ -0,0 +1,40 @@
+/***********************
+ * @file: os_tlsf.h
+ * @author: Feijie Luo
+ * @Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     Feijie Luo   First version
+ * 2026-10-19     Feijie Luo   Add os_tlsf_free_info
+ * 2026-10-19     Feijie Luo   Add block walk and boundary tag checks
+ * @note:
+ ***********************/
+
+#ifndef _OS_TLSF_H_
+#define _OS_TLSF_H_
+
+#include "../../os_def.h"
+
+/**
+ * Two-level segregated fit allocator. Allocation and free are O(1):
+ * free blocks are kept in size-class lists indexed by two bitmaps, and
+ * neighbours are coalesced through boundary tags.
+ *
+ * The control structure is placed at the head of the memory handed to
+ * os_tlsf_create(), the rest of the memory becomes the pool.
+ */
+typedef void *OS_TLSF_HANDLE;
+
+OS_TLSF_HANDLE os_tlsf_create(void *_mem, unsigned int _size);
+void *os_tlsf_malloc(OS_TLSF_HANDLE _tlsf, unsigned int _size);
+void *os_tlsf_malloc_aligned(OS_TLSF_HANDLE _tlsf, unsigned int _size, unsigned int _align);
+void os_tlsf_free(OS_TLSF_HANDLE _tlsf, void *_ptr);
+os_handle_state_t os_tlsf_resize(OS_TLSF_HANDLE _tlsf, void *_ptr, unsigned int _size);
+unsigned int os_tlsf_block_size(void *_ptr);
+unsigned int os_tlsf_used(OS_TLSF_HANDLE _tlsf);
+void os_tlsf_free_info(OS_TLSF_HANDLE _tlsf, unsigned int *_free_num, unsigned int *_largest);
+bool os_tlsf_block_is_free(const void *_ptr);
+bool os_tlsf_block_check(OS_TLSF_HANDLE _tlsf, const void *_ptr);
+void *os_tlsf_block_walk(OS_TLSF_HANDLE _tlsf, const void *_ptr);
+unsigned int os_tlsf_overhead(void);
+
+#endif
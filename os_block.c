@@ -6,6 +6,7 @@
  * 2022-09-10     Feijie Luo   First version
  * 2023-10-13     Feijie Luo   Decouple from os_task_state
  * 2023-10-19     Feijie Luo   Fix bug in function os_task_is_block
+ * 2026-10-19     Feijie Luo   Add os_block_requeue_task, record _block_mount
  * @note:
  ***********************/
 #include "os_block.h"
@@ -69,6 +70,7 @@ void os_block_init(struct os_block_object *_block_obj, os_block_type_t _block_ty
 {
     _block_obj->_type = _block_type;
     list_head_init(&_block_obj->_list);
+    list_head_init(&_block_obj->_wait_list);
 }
 
 /* 阻塞类对象去初始化 */
@@ -76,6 +78,7 @@ void os_block_deinit(struct os_block_object *_block_obj)
 {
     _block_obj->_type = OS_BLOCK_NONE;
     list_head_init(&_block_obj->_list);
+    list_head_init(&_block_obj->_wait_list);
 }
 
 /* 检测阻塞类对象链表是否为空 */
@@ -98,6 +101,7 @@ os_handle_state_t os_add_block_task(struct task_control_block *_task_tcb,
     // 先将线程从优先队列中移除
     os_rq_del_task(_task_tcb);
     __os_block_list_add(_block_obj, _task_tcb);
+    _task_tcb->_block_mount = _block_obj;
 
     // 状态更新
     os_task_state_set_blocking(_task_tcb);
@@ -126,6 +130,25 @@ os_handle_state_t os_add_tick_block_task(struct task_control_block *_task_tcb,
     return OS_HANDLE_SUCCESS;
 }
 
+/*
+ *@func: 将阻塞中的线程转移到另一个阻塞类对象上
+ *@note: 线程保持阻塞状态, 其在tick上的挂载(超时)不受影响
+ */
+os_handle_state_t os_block_requeue_task(struct task_control_block *_task_tcb,
+                                        struct os_block_object *_block_obj)
+{
+    if (NULL == _task_tcb ||
+        NULL == _block_obj ||
+        !os_task_is_block(_task_tcb))
+        return OS_HANDLE_FAIL;
+
+    __os_block_list_del(_task_tcb);
+    __os_block_list_add(_block_obj, _task_tcb);
+    _task_tcb->_block_mount = _block_obj;
+
+    return OS_HANDLE_SUCCESS;
+}
+
 /*
  *@func: 将线程从阻塞类对象队列中唤醒
  */
@@ -5,6 +5,7 @@
  * Date           Author       Notes
  * 2022-09-10     Feijie Luo   First version
  * 2023-10-13     Feijie Luo   decouple from os_task_state
+ * 2026-10-19     Feijie Luo   Add _wait_list for os_wait_multiple
  * @note:
  ***********************/
 #ifndef _OS_BLOCK_H_
@@ -18,11 +19,19 @@ typedef enum os_block_type {
     OS_BLOCK_SEM = (3),
     OS_BLOCK_MQUEUE = (4),
     OS_BLOCK_SYS_OWNED = (5),
+    OS_BLOCK_RWLOCK = (6),
+    OS_BLOCK_COND = (7),
+    OS_BLOCK_WAIT_MULTIPLE = (8),
+    OS_BLOCK_RINGBUF = (9),
+    OS_BLOCK_TOPIC = (10),
+    OS_BLOCK_WORKQUEUE = (11),
 } os_block_type_t;
 
 struct os_block_object {
     os_block_type_t _type;
     struct list_head _list;
+    // nodes of tasks waiting on several objects at once, see os_wait.h
+    struct list_head _wait_list;
 };
 
 bool os_task_is_block(struct task_control_block *_task_tcb);
@@ -33,6 +42,8 @@ os_handle_state_t os_add_block_task(struct task_control_block *_task_tcb,
                                     struct os_block_object *_block_obj);
 os_handle_state_t os_add_tick_block_task(struct task_control_block *_task_tcb,
                                          struct os_block_object *_block_obj);
+os_handle_state_t os_block_requeue_task(struct task_control_block *_task_tcb,
+                                        struct os_block_object *_block_obj);
 os_handle_state_t os_block_wakeup_task(struct task_control_block *_task_tcb);
 void os_block_wakeup_first_task(struct os_block_object *_block_obj,
                                 void (*callback)(struct task_control_block *task));
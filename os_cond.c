@@ -0,0 +1,173 @@
+/***********************
+ * @file: os_cond.c
+ * @author: Feijie Luo
+ * @Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     Feijie Luo   First version
+ * @note:
+ ***********************/
+
+#include "os_block.h"
+#include "os_cond.h"
+#include "os_core.h"
+#include "os_mutex.h"
+#include "os_sched.h"
+#include "os_tick.h"
+
+#include "board/libcpu_headfile.h"
+
+#include "stddef.h"
+
+os_private inline void __os_cond_wakeup_task_cb(struct task_control_block *tcb)
+{
+    // 将该任务从挂载的tick上摘掉
+    list_del_init(&(tcb->_bt_nd));
+}
+
+/*
+ *@func: 唤醒条件变量上的第一个任务
+ *@note: 锁仍被持有时, 任务被直接转移到锁的阻塞队列, 避免唤醒后立即再次阻塞在锁上
+ */
+os_private void __os_cond_wakeup_first(struct os_cond *cond, bool _requeue_only)
+{
+    struct task_control_block *_tcb =
+        os_list_first_entry(&cond->_block_obj._list, struct task_control_block, _slot_nd);
+    if (_requeue_only || os_mutex_is_owned(cond->_mutex))
+        __os_mutex_requeue_task(cond->_mutex, _tcb);
+    else
+        os_block_wakeup_first_task(&cond->_block_obj, __os_cond_wakeup_task_cb);
+}
+
+/*
+ *@func: 等待结束后重新获得锁
+ */
+os_private os_handle_state_t __os_cond_wait_finish(struct os_mutex *mutex,
+                                                   struct task_control_block *_current_task_tcb,
+                                                   unsigned int _nesting)
+{
+    bool _is_timeout;
+
+    __OS_OWNED_ENTER_CRITICAL
+    _is_timeout = (_current_task_tcb->_task_block_state == OS_TASK_BLOCK_TIMEOUT);
+    _current_task_tcb->_task_block_state = OS_TASK_BLOCK_NONE;
+    // 已被转移到锁的阻塞队列并由锁的释放者唤醒, 直接成为锁的拥有者
+    if (!_is_timeout &&
+        _current_task_tcb->_block_mount == &mutex->_block_obj &&
+        !os_mutex_is_owned(mutex)) {
+        __os_mutex_owner_set(mutex, _current_task_tcb, _nesting);
+        __OS_OWNED_EXIT_CRITICAL
+        return OS_HANDLE_SUCCESS;
+    }
+    __OS_OWNED_EXIT_CRITICAL
+
+    // 无论是否超时, 返回时都必须持有锁
+    os_mutex_lock(mutex, OS_MUTEX_NEVER_TIMEOUT);
+    mutex->_lock_nesting = _nesting;
+    return _is_timeout ? OS_HANDLE_FAIL : OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 初始化条件变量
+ */
+os_handle_state_t os_cond_init(struct os_cond *cond)
+{
+    if (NULL == cond)
+        return OS_HANDLE_FAIL;
+    cond->_mutex = NULL;
+    os_block_init(&cond->_block_obj, OS_BLOCK_COND);
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 销毁条件变量, 存在等待任务时失败
+ */
+os_handle_state_t os_cond_destory(struct os_cond *cond)
+{
+    if (NULL == cond)
+        return OS_HANDLE_FAIL;
+    __OS_OWNED_ENTER_CRITICAL
+    if (!os_block_list_is_empty(&cond->_block_obj)) {
+        __OS_OWNED_EXIT_CRITICAL
+        return OS_HANDLE_FAIL;
+    }
+    cond->_mutex = NULL;
+    os_block_deinit(&cond->_block_obj);
+    __OS_OWNED_EXIT_CRITICAL
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 原子地释放锁并在条件变量上等待, 返回前重新获得锁
+ *@note: 超时返回 OS_HANDLE_FAIL, 此时同样持有锁
+ */
+os_handle_state_t os_cond_wait(struct os_cond *cond, struct os_mutex *mutex, unsigned int time_out)
+{
+    if (NULL == cond ||
+        NULL == mutex ||
+        0 == time_out)
+        return OS_HANDLE_FAIL;
+
+    __OS_OWNED_ENTER_CRITICAL
+
+    struct task_control_block *_current_task_tcb = os_get_current_task_tcb();
+    // 必须持有锁, 并且所有等待者使用同一把锁
+    if (!os_mutex_is_self(mutex) ||
+        (cond->_mutex != mutex && !os_block_list_is_empty(&cond->_block_obj))) {
+        __OS_OWNED_EXIT_CRITICAL
+        return OS_HANDLE_FAIL;
+    }
+
+    cond->_mutex = mutex;
+    unsigned int _nesting = __os_mutex_release_for_wait(mutex);
+    // 将当前任务挂起
+    os_add_tick_task(_current_task_tcb, time_out, &cond->_block_obj);
+    __OS_OWNED_EXIT_CRITICAL
+    __os_sched();
+
+    // 该处是为了给软中断异常被触发前留足时间
+    while (os_task_is_block(_current_task_tcb)) {
+    };
+
+    return __os_cond_wait_finish(mutex, _current_task_tcb, _nesting);
+}
+
+/*
+ *@func: 唤醒一个等待的任务
+ */
+os_handle_state_t os_cond_signal(struct os_cond *cond)
+{
+    if (NULL == cond)
+        return OS_HANDLE_FAIL;
+    __OS_OWNED_ENTER_CRITICAL
+    if (os_block_list_is_empty(&cond->_block_obj)) {
+        __OS_OWNED_EXIT_CRITICAL
+        return OS_HANDLE_SUCCESS;
+    }
+    __os_cond_wakeup_first(cond, false);
+    __OS_OWNED_EXIT_CRITICAL
+    __os_sched();
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 唤醒所有等待的任务
+ *@note: 至多唤醒一个任务, 其余任务被转移到锁的阻塞队列, 依次由锁的释放者唤醒,
+ *       以避免所有任务同时被唤醒后再争抢同一把锁
+ */
+os_handle_state_t os_cond_broadcast(struct os_cond *cond)
+{
+    if (NULL == cond)
+        return OS_HANDLE_FAIL;
+    __OS_OWNED_ENTER_CRITICAL
+    if (os_block_list_is_empty(&cond->_block_obj)) {
+        __OS_OWNED_EXIT_CRITICAL
+        return OS_HANDLE_SUCCESS;
+    }
+    // 第一个任务若被唤醒, 它会在运行时获得锁, 因此其余任务只需转移
+    __os_cond_wakeup_first(cond, false);
+    while (!os_block_list_is_empty(&cond->_block_obj))
+        __os_cond_wakeup_first(cond, true);
+    __OS_OWNED_EXIT_CRITICAL
+    __os_sched();
+    return OS_HANDLE_SUCCESS;
+}
@@ -0,0 +1,36 @@
+/***********************
+ * @file: os_cond.h
+ * @author: Feijie Luo
+ * @Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     Feijie Luo   First version
+ * @note:
+ ***********************/
+
+#ifndef _OS_COND_H_
+#define _OS_COND_H_
+
+#include "os_config.h"
+#include "os_core.h"
+#include "os_block.h"
+#include "os_mutex.h"
+
+#define OS_COND_NEVER_TIMEOUT (OS_NEVER_TIME_OUT)
+
+/*
+ * 条件变量, 与 os_mutex 配合使用.
+ * 同一时刻在同一个条件变量上等待的任务必须使用同一把锁.
+ */
+typedef struct os_cond {
+    struct os_block_object _block_obj;
+    // 等待者所使用的锁
+    struct os_mutex *_mutex;
+} os_cond_t;
+
+os_handle_state_t os_cond_init(struct os_cond *cond);
+os_handle_state_t os_cond_destory(struct os_cond *cond);
+os_handle_state_t os_cond_wait(struct os_cond *cond, struct os_mutex *mutex, unsigned int time_out);
+os_handle_state_t os_cond_signal(struct os_cond *cond);
+os_handle_state_t os_cond_broadcast(struct os_cond *cond);
+
+#endif
@@ -29,10 +29,43 @@
 #define CONFIG_HEAP_SIZE (20480)
 // the size of kernel heap, unit: byte
 #define CONFIG_KERNEL_HEAP_SIZE (10240)
+// OS_MALLOC_CAP_* attributes of the user heap. All SRAM of the ch32v307 is reachable by DMA,
+// boards with a dedicated DMA region (e.g. hpm6750) use OS_MALLOC_CAP_DEFAULT instead
+#define CONFIG_HEAP_CAPS (OS_MALLOC_CAP_DMA)
+// the number of heap regions, including the user heap
+#define CONFIG_OS_HEAP_REGION_NUM (4)
+// the data cache line size, DMA buffers are aligned and rounded to whole lines
+#define CONFIG_OS_CACHE_LINE_SIZE (64)
+// use the O(1) TLSF allocator instead of first-fit for all heaps
+#define CONFIG_OS_MALLOC_TLSF
+// the largest TLSF heap is (1 << CONFIG_OS_TLSF_FL_INDEX_MAX) bytes
+#define CONFIG_OS_TLSF_FL_INDEX_MAX (20)
+// charge heap blocks to the allocating task, costs one word per block
+#define CONFIG_OS_MALLOC_TASK_STATS
+// the number of blocks in each os_malloc_isr() pool of 32/64/128/256 bytes,
+// 0 serves os_malloc_isr() from the kernel heap only
+#define CONFIG_OS_MALLOC_ISR_POOL_NUM (0)
+// the number of freed blocks of each size class (16/32/64/128 bytes) a task keeps
+// for os_malloc_safe(), 0 disables the per-task caches. A task may hold up to
+// 240 * CONFIG_OS_MALLOC_CACHE_NUM bytes plus block overhead in its cache
+#define CONFIG_OS_MALLOC_CACHE_NUM (4)
+// the number of blocks moved between a task cache and the user heap under one lock
+#define CONFIG_OS_MALLOC_CACHE_BATCH (2)
+// debug heap: tail canaries, the allocating task and caller PC in every block,
+// checks on free and os_malloc_verifier_create(), costs 12 more bytes per block
+// #define CONFIG_OS_MALLOC_DEBUG
+// the number of blocks of each heap the verifier task checks per step
+#define CONFIG_OS_MALLOC_VERIFY_BUDGET (16)
+// the interval between verifier steps, unit: ms
+#define CONFIG_OS_MALLOC_VERIFY_PERIOD_MS (100)
+// the number of tick nodes in the static pool, the kernel heap is used beyond it
+#define CONFIG_OS_TICK_POOL_NUM (16)
 // the size of buffer in os_printk, unit: byte
 #define CONFIG_OS_PRINTK_BUF_SIZE  (512)
-// the number of int-post object buffer
-#define CONFIG_OS_INT_POST_NUM (10)
+// the number of int-post object buffer, must be a power of 2
+#define CONFIG_OS_INT_POST_NUM (16)
+// the number of int-post types that can be registered at runtime
+#define CONFIG_OS_INT_POST_USER_TYPES (4)
 
 #ifdef CONFIG_FISH
 // the priority of FISH thread
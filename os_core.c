@@ -6,6 +6,9 @@
  * 2022-09-10     Feijie Luo   First version
  * 2023-10-17     Feijie Luo   Add task status update function
  * 2023-11-07     Feijie Luo   Add ps cmd.
+ * 2026-10-19     Feijie Luo   Add os_task_get_by_id, clear heap accounting on create.
+ * 2026-10-19     Feijie Luo   Flush the task allocation cache on exit.
+ * 2026-10-19     Feijie Luo   Tag tasks with a heap generation.
  * @note:
  ***********************/
 
@@ -19,6 +22,10 @@
 #include "board/libcpu_headfile.h"
 
 static struct task_control_block *_os_id_tcb_tab[OS_TASK_MAX_ID];
+#ifdef CONFIG_OS_MALLOC_TASK_STATS
+// 每创建一个线程加一, 用于区分复用同一id的线程
+static unsigned int _os_task_heap_gen = 0;
+#endif
 
 /***********************************************************************************/
 /***********************************************************************************/
@@ -83,6 +90,10 @@ inline void os_task_state_set_blocking(struct task_control_block *_task_tcb)
 /* 线程退出 */
 os_private void __os_task_exit_handle(void)
 {
+#if CONFIG_OS_MALLOC_CACHE_NUM > 0
+    // 归还线程缓存的内存块
+    os_malloc_cache_flush();
+#endif
     __OS_OWNED_ENTER_CRITICAL
 
     struct task_control_block *_ct_tcb = os_get_current_task_tcb();
@@ -138,6 +149,13 @@ os_handle_state_t os_task_create(struct task_control_block *_task_tcb,
     os_task_state_set_new(_task_tcb);
     _task_tcb->_task_timeslice = 0;
     _task_tcb->_block_mount = NULL;
+#ifdef CONFIG_OS_MALLOC_TASK_STATS
+    _task_tcb->_heap_bytes = 0;
+    _task_tcb->_heap_gen = ++_os_task_heap_gen;
+#endif
+#if CONFIG_OS_MALLOC_CACHE_NUM > 0
+    os_malloc_cache_init(&_task_tcb->_heap_cache);
+#endif
 
     // 链表初始化
     list_head_init(&_task_tcb->_bt_nd);
@@ -153,6 +171,14 @@ os_handle_state_t os_task_create(struct task_control_block *_task_tcb,
     return OS_HANDLE_SUCCESS;
 }
 
+/* 根据id获取线程, 该id未被使用时返回NULL */
+struct task_control_block *os_task_get_by_id(unsigned int _task_id)
+{
+    if (_task_id >= OS_TASK_MAX_ID)
+        return NULL;
+    return _os_id_tcb_tab[_task_id];
+}
+
 const char _os_state_str[5][11] = {
     "   NEW    ",
     "  READY   ",
@@ -6,6 +6,9 @@
  * 2022-09-10     Feijie Luo   First version
  * 2023-10-11     Feijie Luo   Add sp pointer
  * 2023-10-13     Feijie Luo   Add OS_TASK_SLEEP_TIME_OUT.
+ * 2026-10-19     Feijie Luo   Add per-task heap accounting.
+ * 2026-10-19     Feijie Luo   Add per-task allocation caches.
+ * 2026-10-19     Feijie Luo   Add a heap generation to tell reused task ids apart.
  * @note:
  ***********************/
 
@@ -16,6 +19,10 @@
 #include "os_def.h"
 #include "os_list.h"
 
+#if CONFIG_OS_MALLOC_CACHE_NUM > 0
+#include "components/memory/os_malloc.h"
+#endif
+
 typedef void (*__task_fn_)(void *_arg);
 
 typedef unsigned int os_task_stack_t;
@@ -52,12 +59,25 @@ typedef struct task_control_block {
     unsigned int _task_id;
     unsigned int _task_timeslice;
 
+    // the block object that the task was last mounted on
     struct os_block_object *_block_mount;
 
     // mount to the TICK with BLOCK
     struct list_head _bt_nd;
     // mount to the BLOCK
     struct list_head _slot_nd;
+
+#ifdef CONFIG_OS_MALLOC_TASK_STATS
+    // bytes of heap blocks allocated by the task and not yet freed
+    unsigned int _heap_bytes;
+    // tells the task apart from exited tasks that had the same id
+    unsigned int _heap_gen;
+#endif
+
+#if CONFIG_OS_MALLOC_CACHE_NUM > 0
+    // freed blocks kept for the task's next os_malloc_safe()
+    struct os_malloc_cache _heap_cache;
+#endif
 } tcb_t;
 
 os_handle_state_t os_task_create(struct task_control_block *_task_tcb,
@@ -68,6 +88,8 @@ os_handle_state_t os_task_create(struct task_control_block *_task_tcb,
                                  void *_entry_fn_arg,
                                  const char *_task_name);
 
+struct task_control_block *os_task_get_by_id(unsigned int _task_id);
+
 bool os_task_state_is_new(struct task_control_block *_task_tcb);
 void os_task_state_set_new(struct task_control_block *_task_tcb);
 bool os_task_state_is_ready(struct task_control_block *_task_tcb);
@@ -0,0 +1,255 @@
+/***********************
+ * @file: os_coroutine.c
+ * @author: Feijie Luo
+ * @Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     Feijie Luo   First version
+ * @note:
+ ***********************/
+
+#include "os_coroutine.h"
+#include "os_core.h"
+#include "os_mqueue.h"
+#include "os_sched.h"
+#include "os_soft_timer.h"
+
+#include "board/libcpu_headfile.h"
+
+#include "stddef.h"
+
+os_private inline unsigned int __os_co_now(void)
+{
+    return os_get_timestamp().c;
+}
+
+/*
+ *@func: 检查协程等待的对象是否就绪, 信号量在此处被获取
+ *@note: 消息队列只检查非空, 协程恢复后以 OS_MQUEUE_NO_WAIT 接收
+ */
+os_private bool __os_co_await_ready(struct os_co *co)
+{
+    if (NULL == co->_await_obj)
+        return false;
+    switch (co->_await_type) {
+    case OS_WAIT_OBJ_SEM:
+        return (OS_HANDLE_SUCCESS == os_sem_take((struct os_sem *)co->_await_obj, OS_SEM_NO_WAIT));
+    case OS_WAIT_OBJ_MQUEUE:
+        return !os_mqueue_is_empty((struct os_mqueue *)co->_await_obj);
+    default:
+        return false;
+    }
+}
+
+/*
+ *@func: 判断协程是否可以继续运行, 超时时设置 _timed_out
+ */
+os_private bool __os_co_runnable(struct os_co *co, unsigned int now)
+{
+    if (!co->_awaiting)
+        return true;
+    if (__os_co_await_ready(co)) {
+        co->_awaiting = false;
+        co->_timed_out = false;
+        return true;
+    }
+    if (co->_has_deadline && (int)(co->_deadline - now) <= 0) {
+        co->_awaiting = false;
+        co->_timed_out = true;
+        return true;
+    }
+    return false;
+}
+
+/*
+ *@func: 将新启动的协程加入调度链表
+ */
+os_private void __os_co_sched_collect(struct os_co_sched *sched)
+{
+    __OS_OWNED_ENTER_CRITICAL
+    while (!list_empty(&sched->_new_list)) {
+        struct os_co *_co = os_list_first_entry(&sched->_new_list, struct os_co, _nd);
+        list_del_init(&_co->_nd);
+        list_add_tail(&sched->_co_list, &_co->_nd);
+    }
+    __OS_OWNED_EXIT_CRITICAL
+}
+
+/*
+ *@func: 运行一轮所有可运行的协程, 返回是否有协程让出执行权(需要立即再运行一轮)
+ */
+os_private bool __os_co_sched_pass(struct os_co_sched *sched)
+{
+    struct list_head *_pos = sched->_co_list.next;
+    bool _again = false;
+
+    while (_pos != &sched->_co_list) {
+        struct os_co *_co = os_list_entry(_pos, struct os_co, _nd);
+        _pos = _pos->next;
+
+        if (!__os_co_runnable(_co, __os_co_now()))
+            continue;
+        switch (_co->_fn(_co)) {
+        case OS_CO_EXITED:
+            list_del_init(&_co->_nd);
+            break;
+        case OS_CO_YIELDED:
+            _again = true;
+            break;
+        default:
+            // 已经到期的等待(如延时0个tick)在下一轮立即处理
+            if (_co->_has_deadline && (int)(_co->_deadline - __os_co_now()) <= 0)
+                _again = true;
+            break;
+        }
+    }
+    return _again;
+}
+
+/*
+ *@func: 所有协程都在等待时, 同时等待所有对象与最早的到期时刻
+ */
+os_private void __os_co_sched_idle(struct os_co_sched *sched)
+{
+    struct list_head *_pos = NULL;
+    unsigned int _num = 0;
+    unsigned int _now = __os_co_now();
+    unsigned int _time_out = OS_WAIT_NEVER_TIMEOUT;
+
+    sched->_wait_buf[_num].type = OS_WAIT_OBJ_SEM;
+    sched->_wait_buf[_num].obj = &sched->_kick;
+    _num++;
+
+    list_for_each(_pos, &sched->_co_list)
+    {
+        struct os_co *_co = os_list_entry(_pos, struct os_co, _nd);
+        if (!_co->_awaiting)
+            return;
+        if (_co->_has_deadline) {
+            unsigned int _left = ((int)(_co->_deadline - _now) > 0) ? _co->_deadline - _now : 1;
+            if (_left < _time_out)
+                _time_out = _left;
+        }
+        if (NULL == _co->_await_obj)
+            continue;
+        if (_num < sched->_wait_num) {
+            sched->_wait_buf[_num].type = _co->_await_type;
+            sched->_wait_buf[_num].obj = _co->_await_obj;
+            _num++;
+        } else {
+            // 等待节点不足, 以轮询的方式检查剩余的协程
+            _time_out = 1;
+        }
+    }
+
+    if (0 <= os_wait_multiple(sched->_wait_buf, _num, _time_out))
+        os_sem_take(&sched->_kick, OS_SEM_NO_WAIT);
+}
+
+os_private void __os_co_sched_task(void *_arg)
+{
+    os_co_sched_run((struct os_co_sched *)_arg);
+}
+
+/*
+ *@func: 初始化协程调度器
+ *@note: wait_buf 提供 os_wait_multiple 使用的等待节点, 其中一个用于唤醒调度器,
+ *       其余的数量即可同时以阻塞方式等待的协程数, 超出的协程以每tick轮询的方式等待
+ */
+os_handle_state_t os_co_sched_init(struct os_co_sched *sched,
+                                   struct os_wait_obj *wait_buf, unsigned int wait_num)
+{
+    if (NULL == sched ||
+        NULL == wait_buf ||
+        0 == wait_num)
+        return OS_HANDLE_FAIL;
+    list_head_init(&sched->_co_list);
+    list_head_init(&sched->_new_list);
+    os_sem_init(&sched->_kick, 0);
+    sched->_wait_buf = wait_buf;
+    sched->_wait_num = wait_num;
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 为协程调度器创建一个内核任务, 线程控制块与栈由调用者提供
+ */
+os_handle_state_t os_co_sched_create_task(struct os_co_sched *sched,
+                                          struct task_control_block *tcb,
+                                          unsigned int *stack, unsigned int stack_size,
+                                          unsigned char prio, const char *name)
+{
+    if (NULL == sched ||
+        NULL == tcb ||
+        NULL == stack)
+        return OS_HANDLE_FAIL;
+    return os_task_create(tcb, stack, stack_size, prio, __os_co_sched_task, (void *)sched, name);
+}
+
+/*
+ *@func: 在当前任务中运行协程调度器, 不返回
+ */
+void os_co_sched_run(struct os_co_sched *sched)
+{
+    while (1) {
+        __os_co_sched_collect(sched);
+        if (!__os_co_sched_pass(sched))
+            __os_co_sched_idle(sched);
+    }
+}
+
+void os_co_init(struct os_co *co, os_co_fn fn, void *arg)
+{
+    if (NULL == co)
+        return;
+    co->_fn = fn;
+    co->_arg = arg;
+    co->_lc = 0;
+    co->_awaiting = false;
+    co->_await_type = OS_WAIT_OBJ_SEM;
+    co->_await_obj = NULL;
+    co->_has_deadline = false;
+    co->_deadline = 0;
+    co->_timed_out = false;
+    list_head_init(&co->_nd);
+}
+
+inline void *os_co_get_arg(struct os_co *co)
+{
+    return co->_arg;
+}
+
+/*
+ *@func: 启动协程, 可在任务或其他协程中调用
+ */
+os_handle_state_t os_co_start(struct os_co_sched *sched, struct os_co *co)
+{
+    if (NULL == sched ||
+        NULL == co ||
+        NULL == co->_fn)
+        return OS_HANDLE_FAIL;
+    __OS_OWNED_ENTER_CRITICAL
+    if (!list_empty(&co->_nd)) {
+        __OS_OWNED_EXIT_CRITICAL
+        return OS_HANDLE_FAIL;
+    }
+    co->_lc = 0;
+    co->_awaiting = false;
+    list_add_tail(&sched->_new_list, &co->_nd);
+    __OS_OWNED_EXIT_CRITICAL
+    os_sem_release(&sched->_kick);
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 记录协程的等待对象与到期时刻, 由 OS_CO_AWAIT_* 宏调用
+ *@note: obj 为NULL时为单纯延时
+ */
+void __os_co_await(struct os_co *co, enum os_wait_obj_type type, void *obj, unsigned int time_out)
+{
+    co->_awaiting = true;
+    co->_await_type = type;
+    co->_await_obj = obj;
+    co->_timed_out = false;
+    co->_has_deadline = (time_out != OS_CO_NEVER_TIMEOUT);
+    co->_deadline = __os_co_now() + time_out;
+}
@@ -0,0 +1,115 @@
+/***********************
+ * @file: os_coroutine.h
+ * @author: Feijie Luo
+ * @Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     Feijie Luo   First version
+ * @note:
+ ***********************/
+
+#ifndef _OS_COROUTINE_H_
+#define _OS_COROUTINE_H_
+
+#include "os_config.h"
+#include "os_core.h"
+#include "os_list.h"
+#include "os_semaphore.h"
+#include "os_wait.h"
+
+// 协程函数的返回值
+#define OS_CO_WAITING (0)
+#define OS_CO_YIELDED (1)
+#define OS_CO_EXITED  (2)
+
+#define OS_CO_NEVER_TIMEOUT (OS_NEVER_TIME_OUT)
+
+struct os_co;
+typedef int (*os_co_fn)(struct os_co *co);
+
+/*
+ * 无栈协程, 多个协程复用同一个内核任务的栈.
+ * 协程函数在 OS_CO_BEGIN/OS_CO_END 之间编写, 局部变量不会在等待点之间保留,
+ * 需要保留的状态应放在 arg 指向的结构中.
+ */
+struct os_co {
+    os_co_fn _fn;
+    void *_arg;
+    // 恢复执行的位置(行号)
+    unsigned short _lc;
+    // 正在等待的对象
+    bool _awaiting;
+    enum os_wait_obj_type _await_type;
+    void *_await_obj;
+    // 等待的到期时刻(jiffies)
+    bool _has_deadline;
+    unsigned int _deadline;
+    // 上一次等待是否超时
+    bool _timed_out;
+    struct list_head _nd;
+};
+
+/*
+ * 协程调度器, 由一个内核任务依次运行其上的所有协程.
+ * 所有协程都在等待时, 该任务通过 os_wait_multiple 同时等待所有对象与最早的到期时刻.
+ */
+struct os_co_sched {
+    struct list_head _co_list;
+    // 新启动的协程, 在下一轮调度时加入 _co_list
+    struct list_head _new_list;
+    // 用于唤醒调度任务
+    struct os_sem _kick;
+    // os_wait_multiple 使用的等待节点, 由调用者提供
+    struct os_wait_obj *_wait_buf;
+    unsigned int _wait_num;
+};
+
+#define OS_CO_BEGIN(co) \
+    switch ((co)->_lc) { \
+    case 0:
+
+#define OS_CO_END(co) \
+    }                 \
+    (co)->_lc = 0;    \
+    return OS_CO_EXITED;
+
+// 让出执行权, 在下一轮调度时继续
+#define OS_CO_YIELD(co)              \
+    do {                             \
+        (co)->_lc = __LINE__;        \
+        return OS_CO_YIELDED;        \
+    case __LINE__:;                  \
+    } while (0)
+
+#define __OS_CO_AWAIT(co, type, obj, time_out)               \
+    do {                                                     \
+        __os_co_await((co), (type), (void *)(obj), (time_out)); \
+        (co)->_lc = __LINE__;                                \
+        return OS_CO_WAITING;                                \
+    case __LINE__:;                                          \
+    } while (0)
+
+// 等待并获取信号量, 超时后 OS_CO_TIMED_OUT 为真
+#define OS_CO_AWAIT_SEM(co, sem, time_out) \
+    __OS_CO_AWAIT(co, OS_WAIT_OBJ_SEM, sem, time_out)
+// 等待消息队列非空, 随后以 OS_MQUEUE_NO_WAIT 接收
+#define OS_CO_AWAIT_MQUEUE(co, mq, time_out) \
+    __OS_CO_AWAIT(co, OS_WAIT_OBJ_MQUEUE, mq, time_out)
+// 延时 ticks 个tick
+#define OS_CO_DELAY(co, ticks) \
+    __OS_CO_AWAIT(co, OS_WAIT_OBJ_SEM, NULL, ticks)
+
+#define OS_CO_TIMED_OUT(co) ((co)->_timed_out)
+
+os_handle_state_t os_co_sched_init(struct os_co_sched *sched,
+                                   struct os_wait_obj *wait_buf, unsigned int wait_num);
+os_handle_state_t os_co_sched_create_task(struct os_co_sched *sched,
+                                          struct task_control_block *tcb,
+                                          unsigned int *stack, unsigned int stack_size,
+                                          unsigned char prio, const char *name);
+void os_co_sched_run(struct os_co_sched *sched);
+void os_co_init(struct os_co *co, os_co_fn fn, void *arg);
+void *os_co_get_arg(struct os_co *co);
+os_handle_state_t os_co_start(struct os_co_sched *sched, struct os_co *co);
+void __os_co_await(struct os_co *co, enum os_wait_obj_type type, void *obj, unsigned int time_out);
+
+#endif
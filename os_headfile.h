@@ -9,10 +9,19 @@
 #include "os_tick.h"
 #include "os_block.h"
 #include "os_mutex.h"
+#include "os_rwlock.h"
+#include "os_cond.h"
 #include "os_soft_timer.h"
 #include "os_service.h"
 #include "os_semaphore.h"
 #include "os_mqueue.h"
+#include "os_prio_mqueue.h"
+#include "os_ringbuf.h"
+#include "os_stream.h"
+#include "os_topic.h"
+#include "os_workqueue.h"
+#include "os_coroutine.h"
+#include "os_wait.h"
 #include "os_device.h"
 #include "os_int_post.h"
 
@@ -4,6 +4,9 @@
  * @Change Logs:
  * Date           Author       Notes
  * 2024-04-27     Feijie Luo   First version
+ * 2026-10-19     Feijie Luo   Add ringbuf wakeup
+ * 2026-10-19     Feijie Luo   Bounded MPSC queue with overflow accounting
+ * 2026-10-19     Feijie Luo   Handler table, deferred calls and user types
  * @note:
  ***********************/
 
@@ -11,49 +14,168 @@
 #include "os_config.h"
 #include "os_headfile.h"
 
+#if (CONFIG_OS_INT_POST_NUM & (CONFIG_OS_INT_POST_NUM - 1))
+#error "CONFIG_OS_INT_POST_NUM must be a power of 2"
+#endif
+
+#define INT_POST_MASK (CONFIG_OS_INT_POST_NUM - 1)
+
+/*
+ * Bounded MPSC queue: any interrupt (producer) may post, the software interrupt
+ * is the only consumer. Cell i is free for the producer at position pos when
+ * seq == pos, and ready for the consumer when seq == pos + 1.
+ */
 static struct os_int_post_pack _int_post_objs[CONFIG_OS_INT_POST_NUM];
 static volatile os_base_t _post_pos  __OS_ALIGNED__(4);
 static volatile os_base_t _pull_pos  __OS_ALIGNED__(4);
 static volatile os_base_t _lose_post_num __OS_ALIGNED__(4);
+// set while a software interrupt is already pending, so a burst of posts triggers it once
+static volatile os_base_t _sw_pending __OS_ALIGNED__(4);
+
+os_private void __os_int_post_mqueue_send_handle(struct os_int_post_pack *pack)
+{
+    __os_int_post_mqueue_send(pack->obj, pack->msg, pack->msg_size);
+}
+
+os_private void __os_int_post_sem_release_handle(struct os_int_post_pack *pack)
+{
+    __os_int_post_sem_release(pack->obj);
+}
+
+os_private void __os_int_post_ringbuf_wakeup_handle(struct os_int_post_pack *pack)
+{
+    __os_int_post_ringbuf_wakeup(pack->obj);
+}
+
+os_private void __os_int_post_topic_publish_handle(struct os_int_post_pack *pack)
+{
+    __os_int_post_topic_publish(pack->obj, pack->msg, pack->msg_size);
+}
+
+os_private void __os_int_post_call_handle(struct os_int_post_pack *pack)
+{
+    pack->call(pack->obj);
+}
+
+// indexed by enum os_int_post_obj_type, user types are filled in by os_int_post_register
+static os_int_post_handler_t _int_post_handlers[OS_INT_POST_OBJ_TYPE_MAX] = {
+    [OS_INT_POST_OBJ_MQUEUE_SEND] = __os_int_post_mqueue_send_handle,
+    [OS_INT_POST_OBJ_SEM_RELEASE] = __os_int_post_sem_release_handle,
+    [OS_INT_POST_OBJ_RINGBUF_WAKEUP] = __os_int_post_ringbuf_wakeup_handle,
+    [OS_INT_POST_OBJ_TOPIC_PUBLISH] = __os_int_post_topic_publish_handle,
+    [OS_INT_POST_OBJ_CALL] = __os_int_post_call_handle,
+};
+
 void os_int_post_init(void)
 {
     os_memset(_int_post_objs, 0, CONFIG_OS_INT_POST_NUM * sizeof(struct os_int_post_pack));
+    for (os_base_t _i = 0; _i < CONFIG_OS_INT_POST_NUM; ++_i)
+        _int_post_objs[_i].seq = _i;
     _post_pos = 0;
     _pull_pos = 0;
     _lose_post_num = 0;
+    _sw_pending = 0;
 }
 
+/*
+ * Called right after the software interrupt is cleared, so the pending flag is
+ * dropped here: a post racing with the drain below triggers a new interrupt.
+ */
 inline bool __os_int_post_status_called_by_sw(void)
 {
-    return _pull_pos == _post_pos;
+    os_atomic_store(&_sw_pending, 0);
+    struct os_int_post_pack *_cell = &_int_post_objs[_pull_pos & INT_POST_MASK];
+    return os_atomic_load(&_cell->seq) != _pull_pos + 1;
 }
 
 void __os_int_post_handle_called_by_sw(void)
 {
-    while (_pull_pos != _post_pos) {
-        switch (_int_post_objs[_pull_pos].type) {
-        case OS_INT_POST_OBJ_MQUEUE_SEND:
-            __os_int_post_mqueue_send(_int_post_objs[_pull_pos].obj,
-                    _int_post_objs[_pull_pos].msg, _int_post_objs[_pull_pos].msg_size);
-            break;
-        case OS_INT_POST_OBJ_SEM_RELEASE:
-            __os_int_post_sem_release(_int_post_objs[_pull_pos].obj);
+    for (;;) {
+        struct os_int_post_pack *_cell = &_int_post_objs[_pull_pos & INT_POST_MASK];
+        // stop at the first cell that is empty or still being filled
+        if (os_atomic_load(&_cell->seq) != _pull_pos + 1)
             break;
-        default:
-            break;
-        }
+        if ((unsigned int)_cell->type < OS_INT_POST_OBJ_TYPE_MAX &&
+            NULL != _int_post_handlers[_cell->type])
+            _int_post_handlers[_cell->type](_cell);
+        // hand the cell back to producers for the next lap
+        os_atomic_store(&_cell->seq, _pull_pos + CONFIG_OS_INT_POST_NUM);
         _pull_pos++;
-        if (_pull_pos >= CONFIG_OS_INT_POST_NUM)
-            _pull_pos = 0;
     }
 }
 
-void os_int_post(enum os_int_post_obj_type type, void* obj, void* msg, unsigned int msg_size)
+/*
+ * Returns OS_HANDLE_FAIL and counts the post in _lose_post_num when the queue is full.
+ */
+os_private os_handle_state_t __os_int_post(enum os_int_post_obj_type type, void *obj,
+                                           void *msg, unsigned int msg_size,
+                                           os_int_post_call_t call)
+{
+    struct os_int_post_pack *_cell;
+    os_base_t _pos = os_atomic_load(&_post_pos);
+
+    for (;;) {
+        _cell = &_int_post_objs[_pos & INT_POST_MASK];
+        os_base_t _dif = (os_base_t)((unsigned long)os_atomic_load(&_cell->seq) - (unsigned long)_pos);
+        if (0 == _dif) {
+            // claim the cell, on failure _pos is reloaded with the current position
+            if (os_atomic_compare_exchange_strong(&_post_pos, &_pos, _pos + 1))
+                break;
+        } else if (_dif < 0) {
+            // the consumer has not freed this cell yet
+            os_atomic_add(&_lose_post_num, 1);
+            return OS_HANDLE_FAIL;
+        } else {
+            _pos = os_atomic_load(&_post_pos);
+        }
+    }
+
+    _cell->type = type;
+    _cell->obj = obj;
+    _cell->msg = msg;
+    _cell->msg_size = msg_size;
+    _cell->call = call;
+    // publish the cell to the consumer
+    os_atomic_store(&_cell->seq, _pos + 1);
+
+    if (!os_atomic_exchange(&_sw_pending, 1))
+        os_ctx_sw();
+    return OS_HANDLE_SUCCESS;
+}
+
+os_handle_state_t os_int_post(enum os_int_post_obj_type type, void* obj, void* msg, unsigned int msg_size)
+{
+    if ((unsigned int)type >= OS_INT_POST_OBJ_TYPE_MAX ||
+        OS_INT_POST_OBJ_CALL == type)
+        return OS_HANDLE_FAIL;
+    return __os_int_post(type, obj, msg, msg_size, NULL);
+}
+
+/*
+ * Defer call(arg) to the software interrupt, usable from any interrupt.
+ * call runs with the scheduler masked and must not block.
+ */
+os_handle_state_t os_int_post_call(os_int_post_call_t call, void *arg)
+{
+    if (NULL == call)
+        return OS_HANDLE_FAIL;
+    return __os_int_post(OS_INT_POST_OBJ_CALL, arg, NULL, 0, call);
+}
+
+/*
+ * Install the handler of a user type (OS_INT_POST_OBJ_USER + n), usually at startup
+ * before anything posts that type.
+ */
+os_handle_state_t os_int_post_register(enum os_int_post_obj_type type, os_int_post_handler_t handler)
+{
+    if ((unsigned int)type < OS_INT_POST_OBJ_USER ||
+        (unsigned int)type >= OS_INT_POST_OBJ_TYPE_MAX)
+        return OS_HANDLE_FAIL;
+    _int_post_handlers[type] = handler;
+    return OS_HANDLE_SUCCESS;
+}
+
+unsigned int os_int_post_lost_num(void)
 {
-    os_base_t reserve = os_atomic_add_bge_set_strong(&_post_pos, 1, CONFIG_OS_INT_POST_NUM, 0);
-    _int_post_objs[reserve].type = type;
-    _int_post_objs[reserve].obj = obj;
-    _int_post_objs[reserve].msg = msg;
-    _int_post_objs[reserve].msg_size = msg_size;
-    os_ctx_sw();
+    return (unsigned int)os_atomic_load(&_lose_post_num);
 }
@@ -4,6 +4,9 @@
  * @Change Logs:
  * Date           Author       Notes
  * 2024-04-27     Feijie Luo   First version
+ * 2026-10-19     Feijie Luo   Add ringbuf wakeup
+ * 2026-10-19     Feijie Luo   Bounded MPSC queue with overflow accounting
+ * 2026-10-19     Feijie Luo   Handler table, deferred calls and user types
  * @note:
  ***********************/
 
@@ -11,22 +14,41 @@
 #define _OS_INT_POST_H_
 
 #include "os_list.h"
+#include "os_config.h"
 #include "os_def.h"
 enum os_int_post_obj_type {
     OS_INT_POST_OBJ_NONE = 0,
     OS_INT_POST_OBJ_MQUEUE_SEND,
     OS_INT_POST_OBJ_SEM_RELEASE,
+    OS_INT_POST_OBJ_RINGBUF_WAKEUP,
+    OS_INT_POST_OBJ_TOPIC_PUBLISH,
+    // call pack->call(pack->obj), see os_int_post_call
+    OS_INT_POST_OBJ_CALL,
+    // first type that can be registered with os_int_post_register
+    OS_INT_POST_OBJ_USER,
+    OS_INT_POST_OBJ_TYPE_MAX = OS_INT_POST_OBJ_USER + CONFIG_OS_INT_POST_USER_TYPES,
 };
 
+typedef void (*os_int_post_call_t)(void *arg);
+
 struct os_int_post_pack {
+    // sequence number of the cell, tells producers and the consumer whose turn it is
+    volatile os_base_t seq;
     enum os_int_post_obj_type type;
     void *obj;
     void *msg;
     unsigned int msg_size;
+    os_int_post_call_t call;
 };
 
+// runs in the software interrupt with the scheduler masked, must not block
+typedef void (*os_int_post_handler_t)(struct os_int_post_pack *pack);
+
 void os_int_post_init(void);
-void os_int_post(enum os_int_post_obj_type type, void* obj, void* msg, unsigned int msg_size);
+os_handle_state_t os_int_post(enum os_int_post_obj_type type, void* obj, void* msg, unsigned int msg_size);
+os_handle_state_t os_int_post_call(os_int_post_call_t call, void *arg);
+os_handle_state_t os_int_post_register(enum os_int_post_obj_type type, os_int_post_handler_t handler);
+unsigned int os_int_post_lost_num(void);
 void __os_int_post_handle_called_by_sw(void);
 bool __os_int_post_status_called_by_sw(void);
 #endif /* _OS_INT_POST_H_ */
@@ -4,6 +4,15 @@
  * @Change Logs:
  * Date           Author       Notes
  * 2023-10-20     Feijie Luo   First version
+ * 2026-10-19     Feijie Luo   Notify os_wait_multiple waiters
+ * 2026-10-19     Feijie Luo   Fixed-slot ring buffer storage
+ * 2026-10-19     Feijie Luo   Separate sender and receiver wait lists
+ * 2026-10-19     Feijie Luo   Zero-copy loaned slots
+ * 2026-10-19     Feijie Luo   Add os_mqueue_send_urgent
+ * 2026-10-19     Feijie Luo   Add batch send and receive
+ * 2026-10-19     Feijie Luo   Fix slot size overflow for messages near 64KB
+ * 2026-10-19     Feijie Luo   Keep the total wait within time_out across retries
+ * 2026-10-19     Feijie Luo   Wake urgent senders queued behind normal ones
  * @note:
  ***********************/
 
@@ -12,37 +21,365 @@
 #include "os_config.h"
 #include "os_mqueue.h"
 #include "os_sched.h"
+#include "os_soft_timer.h"
 #include "os_tick.h"
+#include "os_wait.h"
 #include "stddef.h"
 #include "string.h"
 #include "components/lib/os_string.h"
 
-struct mqueue_msg_pack {
-    void *_buffer;
+/*
+ * Each slot of the ring is a small header followed by the payload,
+ * the whole slot is padded to 4 bytes (see OS_MQUEUE_SLOT_SIZE).
+ */
+struct mqueue_msg_slot {
     unsigned short _size;
-    struct list_head _q_nd;
+    unsigned char _state;
+    unsigned char _reserved;
 };
 
+enum mqueue_slot_state {
+    MQUEUE_SLOT_FREE = 0,
+    // reserved by a sender, not committed yet
+    MQUEUE_SLOT_WRITING = 1,
+    // committed, waiting for a receiver
+    MQUEUE_SLOT_READY = 2,
+    // handed out to a receiver, not released yet
+    MQUEUE_SLOT_READING = 3,
+};
+
+os_private inline struct mqueue_msg_slot *__os_mqueue_slot(struct os_mqueue *mq, unsigned short index)
+{
+    return (struct mqueue_msg_slot *)(mq->_msg_pool + (unsigned int)index * mq->_slot_size);
+}
+
+os_private inline unsigned short __os_mqueue_next(struct os_mqueue *mq, unsigned short index)
+{
+    return (index + 1 == mq->_capacity) ? 0 : index + 1;
+}
+
+os_private inline unsigned short __os_mqueue_prev(struct os_mqueue *mq, unsigned short index)
+{
+    return (0 == index) ? mq->_capacity - 1 : index - 1;
+}
+
+/*
+ * Map a payload pointer handed out by os_mqueue_alloc/os_mqueue_receive_ref back to its slot,
+ * returns NULL if msg does not point at the payload of one of the slots.
+ */
+os_private struct mqueue_msg_slot *__os_mqueue_msg_to_slot(struct os_mqueue *mq, void *msg)
+{
+    unsigned char *_payload = (unsigned char *)msg;
+    unsigned char *_first = mq->_msg_pool + sizeof(struct mqueue_msg_slot);
+
+    if (NULL == mq->_msg_pool || _payload < _first)
+        return NULL;
+    unsigned int _offset = (unsigned int)(_payload - _first);
+    if (_offset % mq->_slot_size ||
+        _offset / mq->_slot_size >= mq->_capacity)
+        return NULL;
+    return (struct mqueue_msg_slot *)msg - 1;
+}
+
+os_private inline void __os_mqueue_send_cb(struct task_control_block *task)
+{
+    // tick
+    list_del_init(&(task->_bt_nd));
+}
+
+os_private inline void __os_mqueue_receive_cb(struct task_control_block *task)
+{
+    // tick
+    list_del_init(&(task->_bt_nd));
+}
+
+os_private inline void __os_mqueue_notify_receiver(struct os_mqueue *mq)
+{
+    // a new message can only make a receiver progress
+    if (os_block_list_is_empty(&mq->_recv_block_obj))
+        os_wait_notify(&mq->_recv_block_obj);
+    else
+        os_block_wakeup_first_task(&mq->_recv_block_obj, __os_mqueue_send_cb);
+}
+
+/*
+ * Reserve the tail slot, the caller guarantees the ring is not full.
+ */
+os_private inline struct mqueue_msg_slot *__os_mqueue_reserve(struct os_mqueue *mq)
+{
+    struct mqueue_msg_slot *_slot = __os_mqueue_slot(mq, mq->_tail);
+    _slot->_state = MQUEUE_SLOT_WRITING;
+    mq->_tail = __os_mqueue_next(mq, mq->_tail);
+    mq->_num_used++;
+    mq->_num_pending++;
+    return _slot;
+}
+
+/*
+ * Mark a reserved slot as committed. Messages become visible to receivers in ring order,
+ * so the commit frontier only moves over consecutive committed slots.
+ */
+os_private void __os_mqueue_publish(struct os_mqueue *mq, struct mqueue_msg_slot *slot, unsigned short msize)
+{
+    slot->_size = msize;
+    slot->_state = MQUEUE_SLOT_READY;
+    while (mq->_num_pending > 0 &&
+           __os_mqueue_slot(mq, mq->_commit)->_state == MQUEUE_SLOT_READY) {
+        mq->_commit = __os_mqueue_next(mq, mq->_commit);
+        mq->_num_pending--;
+        mq->_num_msgs++;
+        __os_mqueue_notify_receiver(mq);
+    }
+}
+
+/*
+ * Claim the slot just before the head for an urgent message, returns NULL if it is not available.
+ * It is either the first free slot before the ring (nothing is loaned out before the head),
+ * or a slot that was released out of order and not reclaimed yet.
+ */
+os_private struct mqueue_msg_slot *__os_mqueue_reserve_head(struct os_mqueue *mq)
+{
+    unsigned short _prev = __os_mqueue_prev(mq, mq->_head);
+    struct mqueue_msg_slot *_slot = __os_mqueue_slot(mq, _prev);
+
+    if (mq->_head == mq->_rel) {
+        if (mq->_num_used >= mq->_capacity)
+            return NULL;
+        mq->_rel = _prev;
+        mq->_num_used++;
+    } else if (_slot->_state != MQUEUE_SLOT_FREE) {
+        return NULL;
+    }
+    mq->_head = _prev;
+    return _slot;
+}
+
+/*
+ * Hand out the head message, the caller guarantees a message is available.
+ */
+os_private inline struct mqueue_msg_slot *__os_mqueue_take(struct os_mqueue *mq)
+{
+    struct mqueue_msg_slot *_slot = __os_mqueue_slot(mq, mq->_head);
+    _slot->_state = MQUEUE_SLOT_READING;
+    mq->_head = __os_mqueue_next(mq, mq->_head);
+    mq->_num_msgs--;
+    return _slot;
+}
+
+/*
+ * Give a slot back. Slots are reclaimed in ring order, so a slot released out of order
+ * is only reused once every slot before it has been released too.
+ */
+os_private void __os_mqueue_reclaim(struct os_mqueue *mq, struct mqueue_msg_slot *slot)
+{
+    slot->_state = MQUEUE_SLOT_FREE;
+    if (mq->_num_used > 0 && slot != __os_mqueue_slot(mq, mq->_rel)) {
+        // released out of order, only an urgent send can reuse the slot just before the head.
+        // Senders of both kinds share the wait list, so wake them all to reach an urgent one.
+        if (slot == __os_mqueue_slot(mq, __os_mqueue_prev(mq, mq->_head))) {
+            while (!os_block_list_is_empty(&mq->_send_block_obj))
+                os_block_wakeup_first_task(&mq->_send_block_obj, __os_mqueue_receive_cb);
+        }
+        return;
+    }
+    while (mq->_num_used > 0 &&
+           __os_mqueue_slot(mq, mq->_rel)->_state == MQUEUE_SLOT_FREE) {
+        mq->_rel = __os_mqueue_next(mq, mq->_rel);
+        mq->_num_used--;
+        // a freed slot can only make a sender progress
+        os_block_wakeup_first_task(&mq->_send_block_obj, __os_mqueue_receive_cb);
+    }
+}
+
+os_private inline unsigned int __os_mqueue_now(void)
+{
+    return os_get_timestamp().c;
+}
+
+/*
+ * Ticks left of a wait of time_out ticks that started at start, so that retries after
+ * a lost race never wait longer in total. Returns OS_MQUEUE_NO_WAIT once it has run out.
+ */
+os_private inline unsigned int __os_mqueue_time_left(unsigned int time_out, unsigned int start)
+{
+    unsigned int _spent = __os_mqueue_now() - start;
+
+    if (time_out == OS_MQUEUE_NEVER_TIMEOUT)
+        return time_out;
+    return (_spent >= time_out) ? OS_MQUEUE_NO_WAIT : time_out - _spent;
+}
+
+/*
+ * Wait until the current task, already mounted on a wait list, is woken up or times out.
+ * Called outside the critical section.
+ */
+os_private os_handle_state_t __os_mqueue_wait(struct task_control_block *_current_task_tcb)
+{
+    os_handle_state_t _ret = OS_HANDLE_SUCCESS;
+
+    __os_sched();
+    while (os_task_is_block(_current_task_tcb)) {
+    };
+
+    __OS_OWNED_ENTER_CRITICAL
+    if (_current_task_tcb->_task_block_state == OS_TASK_BLOCK_TIMEOUT)
+        _ret = OS_HANDLE_FAIL;
+    _current_task_tcb->_task_block_state = OS_TASK_BLOCK_NONE;
+    __OS_OWNED_EXIT_CRITICAL
+    return _ret;
+}
+
+/*
+ * Senders wait on _send_block_obj and are only woken when a slot is reclaimed,
+ * receivers wait on _recv_block_obj and are only woken when a message is committed.
+ * A woken task re-checks the ring, since a task that never blocked may
+ * have taken the slot or the message first.
+ */
+os_private struct mqueue_msg_slot *__os_mqueue_reserve_wait(struct os_mqueue *mq, unsigned int time_out)
+{
+    unsigned int _start = __os_mqueue_now();
+
+    for (;;) {
+        __OS_OWNED_ENTER_CRITICAL
+
+        if (mq->_num_used < mq->_capacity) {
+            struct mqueue_msg_slot *_slot = __os_mqueue_reserve(mq);
+            __OS_OWNED_EXIT_CRITICAL
+            return _slot;
+        }
+
+        unsigned int _left = __os_mqueue_time_left(time_out, _start);
+        if (_left == OS_MQUEUE_NO_WAIT) {
+            __OS_OWNED_EXIT_CRITICAL
+            return NULL;
+        }
+
+        struct task_control_block *_current_task_tcb = os_get_current_task_tcb();
+        os_add_tick_task(_current_task_tcb, _left, &mq->_send_block_obj);
+        __OS_OWNED_EXIT_CRITICAL
+
+        if (OS_HANDLE_FAIL == __os_mqueue_wait(_current_task_tcb))
+            return NULL;
+    }
+}
+
+os_private struct mqueue_msg_slot *__os_mqueue_take_wait(struct os_mqueue *mq, unsigned int time_out)
+{
+    unsigned int _start = __os_mqueue_now();
+
+    for (;;) {
+        __OS_OWNED_ENTER_CRITICAL
+
+        if (mq->_num_msgs != 0) {
+            struct mqueue_msg_slot *_slot = __os_mqueue_take(mq);
+            __OS_OWNED_EXIT_CRITICAL
+            return _slot;
+        }
+
+        unsigned int _left = __os_mqueue_time_left(time_out, _start);
+        if (_left == OS_MQUEUE_NO_WAIT) {
+            __OS_OWNED_EXIT_CRITICAL
+            return NULL;
+        }
+
+        struct task_control_block *_current_task_tcb = os_get_current_task_tcb();
+        os_add_tick_task(_current_task_tcb, _left, &mq->_recv_block_obj);
+        __OS_OWNED_EXIT_CRITICAL
+
+        if (OS_HANDLE_FAIL == __os_mqueue_wait(_current_task_tcb))
+            return NULL;
+    }
+}
+
+os_private void __os_mqueue_setup(struct os_mqueue *mq, void *pool, bool owned,
+                                  unsigned short mnum, unsigned short msize)
+{
+    mq->_capacity = mnum;
+    mq->_msg_size = msize;
+    mq->_slot_size = OS_MQUEUE_SLOT_SIZE(msize);
+    mq->_num_msgs = 0;
+    mq->_num_pending = 0;
+    mq->_num_used = 0;
+    mq->_head = 0;
+    mq->_tail = 0;
+    mq->_commit = 0;
+    mq->_rel = 0;
+    mq->_msg_pool = (unsigned char *)pool;
+    mq->_pool_owned = owned;
+    for (unsigned short _i = 0; _i < mnum; ++_i)
+        __os_mqueue_slot(mq, _i)->_state = MQUEUE_SLOT_FREE;
+    os_block_init(&mq->_send_block_obj, OS_BLOCK_MQUEUE);
+    os_block_init(&mq->_recv_block_obj, OS_BLOCK_MQUEUE);
+}
+
+/*
+ * The whole ring (mnum slots) is taken from the kernel heap once,
+ * send and receive never touch the heap afterwards.
+ */
 os_handle_state_t os_mqueue_init(struct os_mqueue *mq, unsigned short mnum, unsigned short msize)
 {
     if (NULL == mq ||
         0 == mnum ||
-        0 == msize)
+        0 == msize ||
+        OS_MQUEUE_SLOT_SIZE((unsigned int)msize) > ~0U / mnum)
         return OS_HANDLE_FAIL;
-    mq->_capacity = mnum;
-    mq->_msg_size = msize;
-    mq->_num_msgs = 0;
-    os_block_init(&mq->_suspend, OS_BLOCK_MQUEUE);
-    list_head_init(&mq->_msg_queue);
+    void *_pool = os_kmalloc(OS_MQUEUE_POOL_SIZE((unsigned int)mnum, (unsigned int)msize));
+    if (NULL == _pool)
+        return OS_HANDLE_FAIL;
+    __os_mqueue_setup(mq, _pool, true, mnum, msize);
     return OS_HANDLE_SUCCESS;
 }
 
-os_private inline void __os_mqueue_send_cb(struct task_control_block *task)
+/*
+ * Same as os_mqueue_init but the ring lives in a caller-provided buffer,
+ * which must be 4-byte aligned and at least OS_MQUEUE_POOL_SIZE(mnum, msize) bytes.
+ */
+os_handle_state_t os_mqueue_init_static(struct os_mqueue *mq,
+                                        void *pool, unsigned int pool_size,
+                                        unsigned short mnum, unsigned short msize)
 {
-    // tick
-    list_del_init(&(task->_bt_nd));
+    if (NULL == mq ||
+        NULL == pool ||
+        0 == mnum ||
+        0 == msize ||
+        ((unsigned int)pool & 3) ||
+        OS_MQUEUE_SLOT_SIZE((unsigned int)msize) > ~0U / mnum ||
+        pool_size < OS_MQUEUE_POOL_SIZE((unsigned int)mnum, (unsigned int)msize))
+        return OS_HANDLE_FAIL;
+    __os_mqueue_setup(mq, pool, false, mnum, msize);
+    return OS_HANDLE_SUCCESS;
 }
 
+/*
+ * Fails while tasks are still blocked on the queue or slots are still loaned out.
+ */
+os_handle_state_t os_mqueue_destory(struct os_mqueue *mq)
+{
+    if (NULL == mq)
+        return OS_HANDLE_FAIL;
+    __OS_OWNED_ENTER_CRITICAL
+    if (!os_block_list_is_empty(&mq->_send_block_obj) ||
+        !os_block_list_is_empty(&mq->_recv_block_obj) ||
+        mq->_num_used != mq->_num_msgs) {
+        __OS_OWNED_EXIT_CRITICAL
+        return OS_HANDLE_FAIL;
+    }
+    void *_pool = mq->_pool_owned ? mq->_msg_pool : NULL;
+    mq->_msg_pool = NULL;
+    mq->_capacity = 0;
+    mq->_num_msgs = 0;
+    mq->_num_used = 0;
+    os_block_deinit(&mq->_send_block_obj);
+    os_block_deinit(&mq->_recv_block_obj);
+    __OS_OWNED_EXIT_CRITICAL
+    if (NULL != _pool)
+        os_kfree(_pool);
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ * The payload is copied into the reserved slot outside the critical section.
+ */
 os_handle_state_t os_mqueue_send(struct os_mqueue *mq,
                                  const void *buffer, unsigned short msize,
                                  unsigned int time_out)
@@ -53,47 +390,62 @@ os_handle_state_t os_mqueue_send(struct os_mqueue *mq,
         msize > mq->_msg_size)
         return OS_HANDLE_FAIL;
 
+    struct mqueue_msg_slot *_slot = __os_mqueue_reserve_wait(mq, time_out);
+    if (NULL == _slot)
+        return OS_HANDLE_FAIL;
+    os_memcpy((void *)(_slot + 1), buffer, msize);
+
     __OS_OWNED_ENTER_CRITICAL
+    __os_mqueue_publish(mq, _slot, msize);
+    __OS_OWNED_EXIT_CRITICAL
+    __os_sched();
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ * Put the message in front of every pending message, so the next receive returns it.
+ * The payload is copied inside the critical section since the slot is visible at once.
+ */
+os_handle_state_t os_mqueue_send_urgent(struct os_mqueue *mq,
+                                        const void *buffer, unsigned short msize,
+                                        unsigned int time_out)
+{
+    if (NULL == mq ||
+        NULL == buffer ||
+        0 == msize ||
+        msize > mq->_msg_size)
+        return OS_HANDLE_FAIL;
 
-    if (mq->_num_msgs >= mq->_capacity) {
+    unsigned int _start = __os_mqueue_now();
 
-        if (time_out == OS_MQUEUE_NO_WAIT) {
+    for (;;) {
+        __OS_OWNED_ENTER_CRITICAL
+
+        struct mqueue_msg_slot *_slot = __os_mqueue_reserve_head(mq);
+        if (NULL != _slot) {
+            os_memcpy((void *)(_slot + 1), buffer, msize);
+            _slot->_size = msize;
+            _slot->_state = MQUEUE_SLOT_READY;
+            mq->_num_msgs++;
+            __os_mqueue_notify_receiver(mq);
+            __OS_OWNED_EXIT_CRITICAL
+            __os_sched();
+            return OS_HANDLE_SUCCESS;
+        }
+
+        unsigned int _left = __os_mqueue_time_left(time_out, _start);
+        if (_left == OS_MQUEUE_NO_WAIT) {
             __OS_OWNED_EXIT_CRITICAL
             return OS_HANDLE_FAIL;
         }
 
         struct task_control_block *_current_task_tcb = os_get_current_task_tcb();
-        os_add_tick_task(_current_task_tcb, time_out, &mq->_suspend);
+        os_add_tick_task(_current_task_tcb, _left, &mq->_send_block_obj);
         __OS_OWNED_EXIT_CRITICAL
-        __os_sched();
-        while (os_task_is_block(_current_task_tcb)) {
-        };
-
-        __OS_OWNED_ENTER_CRITICAL
 
-        if (_current_task_tcb->_task_block_state == OS_TASK_BLOCK_TIMEOUT) {
-            _current_task_tcb->_task_block_state = OS_TASK_BLOCK_NONE;
-            __OS_OWNED_EXIT_CRITICAL
+        if (OS_HANDLE_FAIL == __os_mqueue_wait(_current_task_tcb))
             return OS_HANDLE_FAIL;
-        } else {
-            _current_task_tcb->_task_block_state = OS_TASK_BLOCK_NONE;
-            __OS_OWNED_EXIT_CRITICAL
-        }
     }
-
-    struct mqueue_msg_pack *mq_pack =
-        (struct mqueue_msg_pack *)os_kmalloc(sizeof(struct mqueue_msg_pack));
-    OS_ASSERT(NULL != mq_pack);
-    mq_pack->_buffer = os_kmalloc(msize);
-    OS_ASSERT(NULL != mq_pack->_buffer);
-    os_memcpy(mq_pack->_buffer, buffer, msize);
-    mq_pack->_size = msize;
-    list_add_tail(&mq->_msg_queue, &mq_pack->_q_nd);
-    mq->_num_msgs++;
-    os_block_wakeup_first_task(&mq->_suspend, __os_mqueue_send_cb);
-    __OS_OWNED_EXIT_CRITICAL
-    __os_sched();
-    return OS_HANDLE_SUCCESS;
 }
 
 void __os_int_post_mqueue_send(struct os_mqueue *mq,
@@ -102,28 +454,19 @@ void __os_int_post_mqueue_send(struct os_mqueue *mq,
     if (NULL == mq ||
         NULL == buffer ||
         0 == msize ||
-        mq->_num_msgs >= mq->_capacity ||
+        mq->_num_used >= mq->_capacity ||
         msize > mq->_msg_size)
         return;
 
-    struct mqueue_msg_pack *mq_pack =
-        (struct mqueue_msg_pack *)os_kmalloc(sizeof(struct mqueue_msg_pack));
-    OS_ASSERT(NULL != mq_pack);
-    mq_pack->_buffer = os_kmalloc(msize);
-    OS_ASSERT(NULL != mq_pack->_buffer);
-    os_memcpy(mq_pack->_buffer, buffer, msize);
-    mq_pack->_size = msize;
-    list_add_tail(&mq->_msg_queue, &mq_pack->_q_nd);
-    mq->_num_msgs++;
-    os_block_wakeup_first_task(&mq->_suspend, __os_mqueue_send_cb);
-}
-
-os_private inline void __os_mqueue_receive_cb(struct task_control_block *task)
-{
-    // tick
-    list_del_init(&(task->_bt_nd));
+    struct mqueue_msg_slot *_slot = __os_mqueue_reserve(mq);
+    os_memcpy((void *)(_slot + 1), buffer, msize);
+    __os_mqueue_publish(mq, _slot, msize);
 }
 
+/*
+ * Copies at most msize bytes of the head message, the payload is copied out
+ * of the loaned slot outside the critical section.
+ */
 os_handle_state_t os_mqueue_receive(struct os_mqueue *mq,
                                     void *buffer, unsigned short msize,
                                     unsigned int time_out)
@@ -134,51 +477,128 @@ os_handle_state_t os_mqueue_receive(struct os_mqueue *mq,
         msize > mq->_msg_size)
         return OS_HANDLE_FAIL;
 
+    struct mqueue_msg_slot *_slot = __os_mqueue_take_wait(mq, time_out);
+    if (NULL == _slot)
+        return OS_HANDLE_FAIL;
+    os_memcpy(buffer, (const void *)(_slot + 1), _slot->_size < msize ? _slot->_size : msize);
+
     __OS_OWNED_ENTER_CRITICAL
+    __os_mqueue_reclaim(mq, _slot);
+    __OS_OWNED_EXIT_CRITICAL
+    __os_sched();
+    return OS_HANDLE_SUCCESS;
+}
 
-    if (mq->_num_msgs == 0) {
+/*
+ * Send up to count messages of msize bytes each, stored back to back in buffer,
+ * in a single critical section with at most one reschedule.
+ * Blocks only while the queue is full, returns the number of messages sent (0 on timeout).
+ */
+unsigned short os_mqueue_send_n(struct os_mqueue *mq,
+                                const void *buffer, unsigned short msize,
+                                unsigned short count, unsigned int time_out)
+{
+    if (NULL == mq ||
+        NULL == buffer ||
+        0 == msize ||
+        0 == count ||
+        msize > mq->_msg_size)
+        return 0;
 
-        if (time_out == OS_MQUEUE_NO_WAIT) {
+    unsigned int _start = __os_mqueue_now();
+
+    for (;;) {
+        __OS_OWNED_ENTER_CRITICAL
+
+        if (mq->_num_used < mq->_capacity) {
+            const unsigned char *_src = (const unsigned char *)buffer;
+            unsigned short _n = 0;
+            while (_n < count && mq->_num_used < mq->_capacity) {
+                struct mqueue_msg_slot *_slot = __os_mqueue_reserve(mq);
+                os_memcpy((void *)(_slot + 1), _src, msize);
+                __os_mqueue_publish(mq, _slot, msize);
+                _src += msize;
+                _n++;
+            }
             __OS_OWNED_EXIT_CRITICAL
-            return OS_HANDLE_FAIL;
+            __os_sched();
+            return _n;
         }
 
-        struct task_control_block *_current_task_tcb = os_get_current_task_tcb();
+        unsigned int _left = __os_mqueue_time_left(time_out, _start);
+        if (_left == OS_MQUEUE_NO_WAIT) {
+            __OS_OWNED_EXIT_CRITICAL
+            return 0;
+        }
 
-        os_add_tick_task(_current_task_tcb, time_out, &mq->_suspend);
+        struct task_control_block *_current_task_tcb = os_get_current_task_tcb();
+        os_add_tick_task(_current_task_tcb, _left, &mq->_send_block_obj);
         __OS_OWNED_EXIT_CRITICAL
-        __os_sched();
 
-        while (os_task_is_block(_current_task_tcb)) {
-        };
+        if (OS_HANDLE_FAIL == __os_mqueue_wait(_current_task_tcb))
+            return 0;
+    }
+}
 
+/*
+ * Receive up to count messages into buffer, each one in its own msize-byte cell,
+ * in a single critical section with at most one reschedule.
+ * Blocks only while the queue is empty, returns the number of messages received (0 on timeout).
+ */
+unsigned short os_mqueue_receive_n(struct os_mqueue *mq,
+                                   void *buffer, unsigned short msize,
+                                   unsigned short count, unsigned int time_out)
+{
+    if (NULL == mq ||
+        NULL == buffer ||
+        0 == msize ||
+        0 == count ||
+        msize > mq->_msg_size)
+        return 0;
+
+    unsigned int _start = __os_mqueue_now();
+
+    for (;;) {
         __OS_OWNED_ENTER_CRITICAL
 
-        if (_current_task_tcb->_task_block_state == OS_TASK_BLOCK_TIMEOUT) {
-            _current_task_tcb->_task_block_state = OS_TASK_BLOCK_NONE;
+        if (mq->_num_msgs != 0) {
+            unsigned char *_dst = (unsigned char *)buffer;
+            unsigned short _n = 0;
+            while (_n < count && mq->_num_msgs != 0) {
+                struct mqueue_msg_slot *_slot = __os_mqueue_take(mq);
+                os_memcpy(_dst, (const void *)(_slot + 1), _slot->_size < msize ? _slot->_size : msize);
+                __os_mqueue_reclaim(mq, _slot);
+                _dst += msize;
+                _n++;
+            }
             __OS_OWNED_EXIT_CRITICAL
-            return OS_HANDLE_FAIL;
-        } else {
-            _current_task_tcb->_task_block_state = OS_TASK_BLOCK_NONE;
+            __os_sched();
+            return _n;
+        }
+
+        unsigned int _left = __os_mqueue_time_left(time_out, _start);
+        if (_left == OS_MQUEUE_NO_WAIT) {
             __OS_OWNED_EXIT_CRITICAL
+            return 0;
         }
-    }
 
-    struct mqueue_msg_pack *_getmsg = NULL;
-    _getmsg = os_list_first_entry(&mq->_msg_queue, struct mqueue_msg_pack, _q_nd);
-    os_memcpy(buffer, _getmsg->_buffer, msize);
-    list_del_init(&_getmsg->_q_nd);
-    os_kfree(_getmsg->_buffer);
-    os_kfree(_getmsg);
+        struct task_control_block *_current_task_tcb = os_get_current_task_tcb();
+        os_add_tick_task(_current_task_tcb, _left, &mq->_recv_block_obj);
+        __OS_OWNED_EXIT_CRITICAL
 
-    mq->_num_msgs--;
+        if (OS_HANDLE_FAIL == __os_mqueue_wait(_current_task_tcb))
+            return 0;
+    }
+}
 
-    os_block_wakeup_first_task(&mq->_suspend, __os_mqueue_receive_cb);
-    __OS_OWNED_EXIT_CRITICAL
-    __os_sched();
-    return OS_HANDLE_SUCCESS;
+inline bool os_mqueue_is_empty(struct os_mqueue *mq)
+{
+    return (0 == mq->_num_msgs);
 }
 
+/*
+ * Drops every committed message, slots that are loaned out are not affected.
+ */
 os_handle_state_t os_mqueue_clear(struct os_mqueue *mq)
 {
     if (NULL == mq)
@@ -189,19 +609,83 @@ os_handle_state_t os_mqueue_clear(struct os_mqueue *mq)
         return OS_HANDLE_SUCCESS;
     }
 
-    while (mq->_num_msgs != 0) {
-        struct mqueue_msg_pack *_getmsg = NULL;
-        _getmsg = os_list_first_entry(&mq->_msg_queue, struct mqueue_msg_pack, _q_nd);
-        list_del_init(&_getmsg->_q_nd);
-        os_kfree(_getmsg->_buffer);
-        os_kfree(_getmsg);
+    while (mq->_num_msgs != 0)
+        __os_mqueue_reclaim(mq, __os_mqueue_take(mq));
+    __OS_OWNED_EXIT_CRITICAL;
+    __os_sched();
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ * Zero-copy send: reserve a slot and return its payload (at most _msg_size bytes),
+ * the sender fills it in place and hands it over with os_mqueue_commit.
+ * Returns NULL on timeout.
+ */
+void *os_mqueue_alloc(struct os_mqueue *mq, unsigned int time_out)
+{
+    if (NULL == mq)
+        return NULL;
+    struct mqueue_msg_slot *_slot = __os_mqueue_reserve_wait(mq, time_out);
+    return (NULL == _slot) ? NULL : (void *)(_slot + 1);
+}
+
+/*
+ * Commit a slot returned by os_mqueue_alloc, msize is the number of valid bytes.
+ */
+os_handle_state_t os_mqueue_commit(struct os_mqueue *mq, void *msg, unsigned short msize)
+{
+    if (NULL == mq ||
+        NULL == msg ||
+        0 == msize ||
+        msize > mq->_msg_size)
+        return OS_HANDLE_FAIL;
+
+    __OS_OWNED_ENTER_CRITICAL
+    struct mqueue_msg_slot *_slot = __os_mqueue_msg_to_slot(mq, msg);
+    if (NULL == _slot || _slot->_state != MQUEUE_SLOT_WRITING) {
+        __OS_OWNED_EXIT_CRITICAL
+        return OS_HANDLE_FAIL;
+    }
+    __os_mqueue_publish(mq, _slot, msize);
+    __OS_OWNED_EXIT_CRITICAL
+    __os_sched();
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ * Zero-copy receive: return the head message in place and store its size in *msize,
+ * the slot stays loaned to the receiver until os_mqueue_release.
+ * Returns NULL on timeout.
+ */
+void *os_mqueue_receive_ref(struct os_mqueue *mq, unsigned short *msize, unsigned int time_out)
+{
+    if (NULL == mq)
+        return NULL;
+    struct mqueue_msg_slot *_slot = __os_mqueue_take_wait(mq, time_out);
+    if (NULL == _slot)
+        return NULL;
+    if (NULL != msize)
+        *msize = _slot->_size;
+    return (void *)(_slot + 1);
+}
 
-        mq->_num_msgs--;
+/*
+ * Release a message returned by os_mqueue_receive_ref.
+ */
+os_handle_state_t os_mqueue_release(struct os_mqueue *mq, void *msg)
+{
+    if (NULL == mq ||
+        NULL == msg)
+        return OS_HANDLE_FAIL;
 
-        os_block_wakeup_first_task(&mq->_suspend, __os_mqueue_receive_cb);
-        // clear
+    __OS_OWNED_ENTER_CRITICAL
+    struct mqueue_msg_slot *_slot = __os_mqueue_msg_to_slot(mq, msg);
+    if (NULL == _slot || _slot->_state != MQUEUE_SLOT_READING) {
+        __OS_OWNED_EXIT_CRITICAL
+        return OS_HANDLE_FAIL;
     }
-    __OS_OWNED_EXIT_CRITICAL;
+    __os_mqueue_reclaim(mq, _slot);
+    __OS_OWNED_EXIT_CRITICAL
     __os_sched();
     return OS_HANDLE_SUCCESS;
 }
@@ -4,6 +4,12 @@
  * @Change Logs:
  * Date           Author       Notes
  * 2023-10-20     Feijie Luo   First version
+ * 2026-10-19     Feijie Luo   Fixed-slot ring buffer storage
+ * 2026-10-19     Feijie Luo   Separate sender and receiver wait lists
+ * 2026-10-19     Feijie Luo   Zero-copy loaned slots
+ * 2026-10-19     Feijie Luo   Add os_mqueue_send_urgent
+ * 2026-10-19     Feijie Luo   Add batch send and receive
+ * 2026-10-19     Feijie Luo   Widen _slot_size for messages near 64KB
  * @note:
  ***********************/
 
@@ -17,25 +23,75 @@
 #define OS_MQUEUE_NO_WAIT          (0)
 #define OS_MQUEUE_NEVER_TIMEOUT    (OS_NEVER_TIME_OUT)
 
+// ÿϢͷĴС
+#define OS_MQUEUE_SLOT_HEAD_SIZE   (4)
+// ÿϢ۵ĴС(4ֽڶ)
+#define OS_MQUEUE_SLOT_SIZE(msize) \
+    ((OS_MQUEUE_SLOT_HEAD_SIZE + (msize) + 3) & ~3)
+// ϢĴ洢ռС,  os_mqueue_init_static
+#define OS_MQUEUE_POOL_SIZE(mnum, msize) \
+    ((mnum) * OS_MQUEUE_SLOT_SIZE(msize))
+
+/*
+ * Ϣ۰˳ξ: Ԥ(д) -> ύ(ɱ) -> (߶ȡ) -> ͷ.
+ * ԤϢۿύ/ͷ, ֻ˳Խ߿ɼ/.
+ */
 struct os_mqueue{
     // ϢС
     unsigned short _msg_size;
     // Ϣе
     unsigned short _capacity;
-    // ǰϢ
+    // ɱյϢ(_head  _commit ֮)
     unsigned short _num_msgs;
-    struct list_head _msg_queue;
-    struct os_block_object _suspend;
+    // ԤδԽ߿ɼϢ۸(_commit  _tail ֮)
+    unsigned short _num_pending;
+    // δյϢ۸(_rel  _tail ֮)
+    unsigned short _num_used;
+    // һȡϢ
+    unsigned short _head;
+    // һԤϢ
+    unsigned short _tail;
+    // һδԽ߿ɼϢ
+    unsigned short _commit;
+    // һδյϢ
+    unsigned short _rel;
+    // Ϣ۴С
+    unsigned int _slot_size;
+    // 洢ռǷں˶ѷ
+    bool _pool_owned;
+    unsigned char *_msg_pool;
+    // ȴϢ۵ķ(з)
+    struct os_block_object _send_block_obj;
+    // ȴϢĽ(зǿ)
+    struct os_block_object _recv_block_obj;
 };
 
 os_handle_state_t os_mqueue_init(struct os_mqueue* mq, unsigned short mnum, unsigned short msize);
+os_handle_state_t os_mqueue_init_static(struct os_mqueue *mq,
+                                        void *pool, unsigned int pool_size,
+                                        unsigned short mnum, unsigned short msize);
+os_handle_state_t os_mqueue_destory(struct os_mqueue *mq);
 os_handle_state_t os_mqueue_send(struct os_mqueue *mq,
                                  const void *buffer, unsigned short msize,
                                  unsigned int time_out);
+os_handle_state_t os_mqueue_send_urgent(struct os_mqueue *mq,
+                                        const void *buffer, unsigned short msize,
+                                        unsigned int time_out);
 void __os_int_post_mqueue_send(struct os_mqueue *mq,
                                const void *buffer, unsigned short msize);
 os_handle_state_t os_mqueue_receive(struct os_mqueue* mq,
                                     void* buffer, unsigned short msize,
                                     unsigned int time_out);
+unsigned short os_mqueue_send_n(struct os_mqueue *mq,
+                                const void *buffer, unsigned short msize,
+                                unsigned short count, unsigned int time_out);
+unsigned short os_mqueue_receive_n(struct os_mqueue *mq,
+                                   void *buffer, unsigned short msize,
+                                   unsigned short count, unsigned int time_out);
 os_handle_state_t os_mqueue_clear(struct os_mqueue* mq);
+void *os_mqueue_alloc(struct os_mqueue *mq, unsigned int time_out);
+os_handle_state_t os_mqueue_commit(struct os_mqueue *mq, void *msg, unsigned short msize);
+void *os_mqueue_receive_ref(struct os_mqueue *mq, unsigned short *msize, unsigned int time_out);
+os_handle_state_t os_mqueue_release(struct os_mqueue *mq, void *msg);
+bool os_mqueue_is_empty(struct os_mqueue *mq);
 #endif
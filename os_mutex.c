@@ -7,6 +7,7 @@
  * 2023-10-13     Feijie Luo   Add os_mutex_lock time out. Fix priority bug in __mutex_owner_change
  * 2023-10-18     Feijie Luo   Change os_mutex_lock return value type
  * 2023-10-18     Feijie Luo   Fix `self bug in function os_mutex_try_lock
+ * 2026-10-19     Feijie Luo   Add internal interfaces for os_cond
  * @note:
  ***********************/
 
@@ -213,6 +214,46 @@ os_handle_state_t os_mutex_unlock(struct os_mutex *_mutex)
     return OS_HANDLE_SUCCESS;
 }
 
+/*
+ *@func: 条件变量等待前完全释放锁(包括递归层数), 返回释放前的递归层数
+ *@note: 调用者需处于临界区并且是锁的拥有者
+ */
+unsigned int __os_mutex_release_for_wait(struct os_mutex *_mutex)
+{
+    unsigned int _nesting = _mutex->_lock_nesting;
+    _mutex->_lock_nesting = 0;
+    __os_mutex_owner_release(_mutex);
+    // 唤醒锁阻塞队列中的第一个任务
+    os_block_wakeup_first_task(&_mutex->_block_obj, __os_mutex_wakeup_task_cb);
+    return _nesting;
+}
+
+/*
+ *@func: 将阻塞中的任务转移到锁的阻塞队列, 由锁的释放者唤醒
+ *@note: 调用者需处于临界区
+ */
+void __os_mutex_requeue_task(struct os_mutex *_mutex, struct task_control_block *_task_tcb)
+{
+    os_block_requeue_task(_task_tcb, &_mutex->_block_obj);
+    // 防止优先级反转
+    if (os_mutex_is_owned(_mutex) &&
+        _mutex->_owner_prio > _task_tcb->_task_priority)
+        __mutex_owner_prio_up(_mutex, _task_tcb->_task_priority);
+}
+
+/*
+ *@func: 将锁的拥有者设置为指定任务, 并恢复递归层数
+ *@note: 调用者需处于临界区并且锁不存在拥有者
+ */
+void __os_mutex_owner_set(struct os_mutex *_mutex,
+                          struct task_control_block *_task_tcb,
+                          unsigned int _nesting)
+{
+    _mutex->_lock_nesting = _nesting;
+    _mutex->_owner_prio = _task_tcb->_task_priority;
+    _mutex->_mutex_owner = _task_tcb;
+}
+
 /*
  *@func: 销毁锁
  */
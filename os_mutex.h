@@ -55,5 +55,10 @@ os_handle_state_t os_mutex_lock(struct os_mutex *_mutex, unsigned int time_out);
 os_handle_state_t os_mutex_unlock(struct os_mutex *_mutex);
 os_mutex_handle_state_t os_mutex_init(struct os_mutex *_mutex, os_mutex_type_t _type);
 os_mutex_handle_state_t os_mutex_destory(struct os_mutex *_mutex);
+unsigned int __os_mutex_release_for_wait(struct os_mutex *_mutex);
+void __os_mutex_requeue_task(struct os_mutex *_mutex, struct task_control_block *_task_tcb);
+void __os_mutex_owner_set(struct os_mutex *_mutex,
+                          struct task_control_block *_task_tcb,
+                          unsigned int _nesting);
 
 #endif
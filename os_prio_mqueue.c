@@ -0,0 +1,280 @@
+/***********************
+ * @file: os_prio_mqueue.c
+ * @author: Feijie Luo
+ * @Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     Feijie Luo   First version
+ * 2026-10-19     Feijie Luo   Re-arm waits with the remaining timeout.
+ * 2026-10-19     Feijie Luo   Reject queues whose pool size overflows 32 bits.
+ * @note:
+ ***********************/
+
+#include "os_block.h"
+#include "os_core.h"
+#include "os_prio_mqueue.h"
+#include "os_sched.h"
+#include "os_soft_timer.h"
+#include "os_tick.h"
+
+#include "board/libcpu_headfile.h"
+#include "components/lib/os_string.h"
+#include "components/memory/os_malloc.h"
+
+#include "stddef.h"
+
+os_private inline void __os_prio_mqueue_wakeup_task_cb(struct task_control_block *tcb)
+{
+    // 将该任务从挂载的tick上摘掉
+    list_del_init(&(tcb->_bt_nd));
+}
+
+os_private inline unsigned int __os_prio_mqueue_now(void)
+{
+    return os_get_timestamp().c;
+}
+
+/*
+ *@func: 从 start 开始等待 time_out 个tick时剩余的tick数, 用完时返回 OS_PRIO_MQUEUE_NO_WAIT
+ *@note: 被唤醒后重试时只等待剩余时间, 总等待时间不超过 time_out
+ */
+os_private inline unsigned int __os_prio_mqueue_time_left(unsigned int time_out, unsigned int start)
+{
+    unsigned int _spent = __os_prio_mqueue_now() - start;
+
+    if (time_out == OS_PRIO_MQUEUE_NEVER_TIMEOUT)
+        return time_out;
+    return (_spent >= time_out) ? OS_PRIO_MQUEUE_NO_WAIT : time_out - _spent;
+}
+
+/*
+ *@func: 等待被唤醒或超时, 在临界区外调用
+ */
+os_private os_handle_state_t __os_prio_mqueue_wait(struct task_control_block *_current_task_tcb)
+{
+    os_handle_state_t _ret = OS_HANDLE_SUCCESS;
+
+    __os_sched();
+    // 该处是为了给软中断异常被触发前留足时间
+    while (os_task_is_block(_current_task_tcb)) {
+    };
+
+    __OS_OWNED_ENTER_CRITICAL
+    if (_current_task_tcb->_task_block_state == OS_TASK_BLOCK_TIMEOUT)
+        _ret = OS_HANDLE_FAIL;
+    _current_task_tcb->_task_block_state = OS_TASK_BLOCK_NONE;
+    __OS_OWNED_EXIT_CRITICAL
+    return _ret;
+}
+
+/*
+ *@func: OS_PRIO_MQUEUE_POOL_SIZE 是否超出32位, levels 与 mnum 不为0
+ */
+os_private inline bool __os_prio_mqueue_pool_overflow(unsigned char levels, unsigned short mnum,
+                                                      unsigned short msize)
+{
+    return OS_PRIO_MQUEUE_SLOT_SIZE((unsigned int)msize) >
+           (~0U - (unsigned int)levels * sizeof(struct list_head)) / mnum;
+}
+
+os_private void __os_prio_mqueue_setup(struct os_prio_mqueue *pq, void *pool, bool owned,
+                                       unsigned char levels, unsigned short mnum, unsigned short msize)
+{
+    unsigned char *_slots = (unsigned char *)pool + levels * sizeof(struct list_head);
+
+    pq->_msg_size = msize;
+    pq->_capacity = mnum;
+    pq->_num_msgs = 0;
+    pq->_levels = levels;
+    pq->_pool_owned = owned;
+    pq->_bitmap = 0;
+    pq->_pool = pool;
+    pq->_level_list = (struct list_head *)pool;
+    for (unsigned char _i = 0; _i < levels; ++_i)
+        list_head_init(&pq->_level_list[_i]);
+    list_head_init(&pq->_free_list);
+    for (unsigned short _i = 0; _i < mnum; ++_i) {
+        struct os_prio_mqueue_slot *_slot =
+            (struct os_prio_mqueue_slot *)(_slots + (unsigned int)_i * OS_PRIO_MQUEUE_SLOT_SIZE(msize));
+        list_add_tail(&pq->_free_list, &_slot->_nd);
+    }
+    os_block_init(&pq->_send_block_obj, OS_BLOCK_MQUEUE);
+    os_block_init(&pq->_recv_block_obj, OS_BLOCK_MQUEUE);
+}
+
+/*
+ *@func: 初始化优先级消息队列, 存储空间一次性从内核堆中分配
+ */
+os_handle_state_t os_prio_mqueue_init(struct os_prio_mqueue *pq, unsigned char levels,
+                                      unsigned short mnum, unsigned short msize)
+{
+    if (NULL == pq ||
+        0 == levels ||
+        levels > OS_PRIO_MQUEUE_MAX_LEVELS ||
+        0 == mnum ||
+        0 == msize ||
+        __os_prio_mqueue_pool_overflow(levels, mnum, msize))
+        return OS_HANDLE_FAIL;
+    void *_pool = os_kmalloc(OS_PRIO_MQUEUE_POOL_SIZE((unsigned int)levels, (unsigned int)mnum, (unsigned int)msize));
+    if (NULL == _pool)
+        return OS_HANDLE_FAIL;
+    __os_prio_mqueue_setup(pq, _pool, true, levels, mnum, msize);
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 使用调用者提供的存储空间初始化优先级消息队列
+ *@note: pool 需4字节对齐, 大小不小于 OS_PRIO_MQUEUE_POOL_SIZE(levels, mnum, msize)
+ */
+os_handle_state_t os_prio_mqueue_init_static(struct os_prio_mqueue *pq,
+                                             void *pool, unsigned int pool_size,
+                                             unsigned char levels,
+                                             unsigned short mnum, unsigned short msize)
+{
+    if (NULL == pq ||
+        NULL == pool ||
+        ((unsigned int)pool & 3) ||
+        0 == levels ||
+        levels > OS_PRIO_MQUEUE_MAX_LEVELS ||
+        0 == mnum ||
+        0 == msize ||
+        __os_prio_mqueue_pool_overflow(levels, mnum, msize) ||
+        pool_size < OS_PRIO_MQUEUE_POOL_SIZE((unsigned int)levels, (unsigned int)mnum, (unsigned int)msize))
+        return OS_HANDLE_FAIL;
+    __os_prio_mqueue_setup(pq, pool, false, levels, mnum, msize);
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 销毁优先级消息队列, 存在等待任务时失败
+ */
+os_handle_state_t os_prio_mqueue_destory(struct os_prio_mqueue *pq)
+{
+    if (NULL == pq)
+        return OS_HANDLE_FAIL;
+    __OS_OWNED_ENTER_CRITICAL
+    if (!os_block_list_is_empty(&pq->_send_block_obj) ||
+        !os_block_list_is_empty(&pq->_recv_block_obj)) {
+        __OS_OWNED_EXIT_CRITICAL
+        return OS_HANDLE_FAIL;
+    }
+    void *_pool = pq->_pool_owned ? pq->_pool : NULL;
+    pq->_pool = NULL;
+    pq->_level_list = NULL;
+    pq->_capacity = 0;
+    pq->_num_msgs = 0;
+    pq->_bitmap = 0;
+    list_head_init(&pq->_free_list);
+    os_block_deinit(&pq->_send_block_obj);
+    os_block_deinit(&pq->_recv_block_obj);
+    __OS_OWNED_EXIT_CRITICAL
+    if (NULL != _pool)
+        os_kfree(_pool);
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 以优先级 prio 发送消息, 同一优先级的消息先进先出
+ */
+os_handle_state_t os_prio_mqueue_send(struct os_prio_mqueue *pq,
+                                      const void *buffer, unsigned short msize,
+                                      unsigned char prio, unsigned int time_out)
+{
+    if (NULL == pq ||
+        NULL == buffer ||
+        0 == msize ||
+        msize > pq->_msg_size ||
+        prio >= pq->_levels)
+        return OS_HANDLE_FAIL;
+
+    unsigned int _start = __os_prio_mqueue_now();
+
+    for (;;) {
+        __OS_OWNED_ENTER_CRITICAL
+
+        if (!list_empty(&pq->_free_list)) {
+            struct os_prio_mqueue_slot *_slot =
+                os_list_first_entry(&pq->_free_list, struct os_prio_mqueue_slot, _nd);
+            list_del_init(&_slot->_nd);
+            os_memcpy((void *)(_slot + 1), buffer, msize);
+            _slot->_size = msize;
+            _slot->_prio = prio;
+            list_add_tail(&pq->_level_list[prio], &_slot->_nd);
+            pq->_bitmap |= (1U << prio);
+            pq->_num_msgs++;
+            os_block_wakeup_first_task(&pq->_recv_block_obj, __os_prio_mqueue_wakeup_task_cb);
+            __OS_OWNED_EXIT_CRITICAL
+            __os_sched();
+            return OS_HANDLE_SUCCESS;
+        }
+
+        unsigned int _left = __os_prio_mqueue_time_left(time_out, _start);
+        if (_left == OS_PRIO_MQUEUE_NO_WAIT) {
+            __OS_OWNED_EXIT_CRITICAL
+            return OS_HANDLE_FAIL;
+        }
+
+        struct task_control_block *_current_task_tcb = os_get_current_task_tcb();
+        os_add_tick_task(_current_task_tcb, _left, &pq->_send_block_obj);
+        __OS_OWNED_EXIT_CRITICAL
+
+        // 被唤醒后重新检查, 空闲消息槽可能已被未阻塞的发送者取走
+        if (OS_HANDLE_FAIL == __os_prio_mqueue_wait(_current_task_tcb))
+            return OS_HANDLE_FAIL;
+    }
+}
+
+/*
+ *@func: 接收优先级最高的消息, 至多拷贝 msize 字节, prio 不为NULL时返回该消息的优先级
+ */
+os_handle_state_t os_prio_mqueue_receive(struct os_prio_mqueue *pq,
+                                         void *buffer, unsigned short msize,
+                                         unsigned char *prio, unsigned int time_out)
+{
+    if (NULL == pq ||
+        NULL == buffer ||
+        0 == msize ||
+        msize > pq->_msg_size)
+        return OS_HANDLE_FAIL;
+
+    unsigned int _start = __os_prio_mqueue_now();
+
+    for (;;) {
+        __OS_OWNED_ENTER_CRITICAL
+
+        if (0 != pq->_bitmap) {
+            unsigned int _level = os_ffb(pq->_bitmap);
+            struct os_prio_mqueue_slot *_slot =
+                os_list_first_entry(&pq->_level_list[_level], struct os_prio_mqueue_slot, _nd);
+            list_del_init(&_slot->_nd);
+            if (list_empty(&pq->_level_list[_level]))
+                pq->_bitmap &= ~(1U << _level);
+            os_memcpy(buffer, (const void *)(_slot + 1), _slot->_size < msize ? _slot->_size : msize);
+            if (NULL != prio)
+                *prio = _slot->_prio;
+            list_add_tail(&pq->_free_list, &_slot->_nd);
+            pq->_num_msgs--;
+            os_block_wakeup_first_task(&pq->_send_block_obj, __os_prio_mqueue_wakeup_task_cb);
+            __OS_OWNED_EXIT_CRITICAL
+            __os_sched();
+            return OS_HANDLE_SUCCESS;
+        }
+
+        unsigned int _left = __os_prio_mqueue_time_left(time_out, _start);
+        if (_left == OS_PRIO_MQUEUE_NO_WAIT) {
+            __OS_OWNED_EXIT_CRITICAL
+            return OS_HANDLE_FAIL;
+        }
+
+        struct task_control_block *_current_task_tcb = os_get_current_task_tcb();
+        os_add_tick_task(_current_task_tcb, _left, &pq->_recv_block_obj);
+        __OS_OWNED_EXIT_CRITICAL
+
+        if (OS_HANDLE_FAIL == __os_prio_mqueue_wait(_current_task_tcb))
+            return OS_HANDLE_FAIL;
+    }
+}
+
+inline bool os_prio_mqueue_is_empty(struct os_prio_mqueue *pq)
+{
+    return (0 == pq->_num_msgs);
+}
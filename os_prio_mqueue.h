@@ -0,0 +1,80 @@
+/***********************
+ * @file: os_prio_mqueue.h
+ * @author: Feijie Luo
+ * @Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     Feijie Luo   First version
+ * @note:
+ ***********************/
+
+#ifndef _OS_PRIO_MQUEUE_H_
+#define _OS_PRIO_MQUEUE_H_
+
+#include "os_block.h"
+#include "os_config.h"
+#include "os_list.h"
+
+#define OS_PRIO_MQUEUE_NO_WAIT       (0)
+#define OS_PRIO_MQUEUE_NEVER_TIMEOUT (OS_NEVER_TIME_OUT)
+// 最多支持的优先级个数
+#define OS_PRIO_MQUEUE_MAX_LEVELS    (32)
+
+// 消息槽头部, 仅由内核使用
+struct os_prio_mqueue_slot {
+    struct list_head _nd;
+    unsigned short _size;
+    unsigned char _prio;
+    unsigned char _reserved;
+};
+
+// 每个消息槽的大小(4字节对齐)
+#define OS_PRIO_MQUEUE_SLOT_SIZE(msize) \
+    ((sizeof(struct os_prio_mqueue_slot) + (msize) + 3) & ~3)
+// 优先级消息队列所需的存储空间大小, 用于 os_prio_mqueue_init_static
+#define OS_PRIO_MQUEUE_POOL_SIZE(levels, mnum, msize) \
+    ((levels) * sizeof(struct list_head) + (mnum) * OS_PRIO_MQUEUE_SLOT_SIZE(msize))
+
+/*
+ * 优先级消息队列, 数值越小优先级越高.
+ * 每个优先级一个先进先出链表, 通过位图在O(1)时间内找到最高优先级的消息.
+ */
+struct os_prio_mqueue {
+    // 消息的最大大小
+    unsigned short _msg_size;
+    // 消息队列的容量
+    unsigned short _capacity;
+    // 当前消息个数
+    unsigned short _num_msgs;
+    // 优先级个数
+    unsigned char _levels;
+    // 存储空间是否由内核堆分配
+    bool _pool_owned;
+    // 非空优先级的位图
+    unsigned int _bitmap;
+    // 各优先级的消息链表, 位于存储空间的起始处
+    struct list_head *_level_list;
+    // 空闲消息槽链表
+    struct list_head _free_list;
+    void *_pool;
+    // 等待空闲消息槽的发送者(队列非满)
+    struct os_block_object _send_block_obj;
+    // 等待消息的接收者(队列非空)
+    struct os_block_object _recv_block_obj;
+};
+
+os_handle_state_t os_prio_mqueue_init(struct os_prio_mqueue *pq, unsigned char levels,
+                                      unsigned short mnum, unsigned short msize);
+os_handle_state_t os_prio_mqueue_init_static(struct os_prio_mqueue *pq,
+                                             void *pool, unsigned int pool_size,
+                                             unsigned char levels,
+                                             unsigned short mnum, unsigned short msize);
+os_handle_state_t os_prio_mqueue_destory(struct os_prio_mqueue *pq);
+os_handle_state_t os_prio_mqueue_send(struct os_prio_mqueue *pq,
+                                      const void *buffer, unsigned short msize,
+                                      unsigned char prio, unsigned int time_out);
+os_handle_state_t os_prio_mqueue_receive(struct os_prio_mqueue *pq,
+                                         void *buffer, unsigned short msize,
+                                         unsigned char *prio, unsigned int time_out);
+bool os_prio_mqueue_is_empty(struct os_prio_mqueue *pq);
+
+#endif
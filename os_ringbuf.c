@@ -0,0 +1,218 @@
+/***********************
+ * @file: os_ringbuf.c
+ * @author: Feijie Luo
+ * @Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     Feijie Luo   First version
+ * 2026-10-19     Feijie Luo   Retry the wakeup on the next push when os_int_post fails.
+ * @note:
+ ***********************/
+
+#include "os_block.h"
+#include "os_core.h"
+#include "os_int_post.h"
+#include "os_ringbuf.h"
+#include "os_sched.h"
+#include "os_tick.h"
+
+#include "board/libcpu_headfile.h"
+#include "components/lib/os_string.h"
+
+#include "stddef.h"
+
+os_private inline void __os_ringbuf_wakeup_task_cb(struct task_control_block *tcb)
+{
+    // 将该任务从挂载的tick上摘掉
+    list_del_init(&(tcb->_bt_nd));
+}
+
+/*
+ *@func: 将数据拷贝到缓冲区的 pos 处, 处理回绕
+ */
+os_private void __os_ringbuf_copy_in(struct os_ringbuf *rb, unsigned int pos,
+                                     const unsigned char *src, unsigned int len)
+{
+    unsigned int _off = pos & (unsigned int)(rb->_size - 1);
+    unsigned int _first = (unsigned int)rb->_size - _off;
+
+    if (_first > len)
+        _first = len;
+    os_memcpy(rb->_buf + _off, src, _first);
+    if (len > _first)
+        os_memcpy(rb->_buf, src + _first, len - _first);
+}
+
+/*
+ *@func: 从缓冲区的 pos 处拷贝数据, 处理回绕
+ */
+os_private void __os_ringbuf_copy_out(struct os_ringbuf *rb, unsigned int pos,
+                                      unsigned char *dst, unsigned int len)
+{
+    unsigned int _off = pos & (unsigned int)(rb->_size - 1);
+    unsigned int _first = (unsigned int)rb->_size - _off;
+
+    if (_first > len)
+        _first = len;
+    os_memcpy(dst, rb->_buf + _off, _first);
+    if (len > _first)
+        os_memcpy(dst + _first, rb->_buf, len - _first);
+}
+
+/*
+ *@func: 消费者读取数据, 不阻塞
+ */
+os_private unsigned int __os_ringbuf_read(struct os_ringbuf *rb, void *buf, unsigned int len)
+{
+    unsigned int _rd = (unsigned int)rb->_rd;
+    unsigned int _used = (unsigned int)os_atomic_load(&rb->_wr) - _rd;
+
+    if (len > _used)
+        len = _used;
+    if (0 == len)
+        return 0;
+    __os_ringbuf_copy_out(rb, _rd, (unsigned char *)buf, len);
+    // 数据拷贝完成后才将空间交还给生产者
+    os_atomic_store(&rb->_rd, (os_base_t)(_rd + len));
+    return len;
+}
+
+/*
+ *@func: 等待结束, 清除等待标志
+ */
+os_private void __os_ringbuf_wait_finish(struct os_ringbuf *rb,
+                                         struct task_control_block *_current_task_tcb)
+{
+    __OS_OWNED_ENTER_CRITICAL
+    os_atomic_store(&rb->_waiting, 0);
+    _current_task_tcb->_task_block_state = OS_TASK_BLOCK_NONE;
+    __OS_OWNED_EXIT_CRITICAL
+}
+
+/*
+ *@func: 消费者等待数据量达到唤醒阈值
+ */
+os_private void __os_ringbuf_wait(struct os_ringbuf *rb, unsigned int time_out)
+{
+    __OS_OWNED_ENTER_CRITICAL
+
+    os_atomic_store(&rb->_waiting, 1);
+    // 设置等待标志后再次检查, 避免生产者在此之前写入而丢失唤醒
+    if (os_ringbuf_used(rb) >= (unsigned int)rb->_threshold) {
+        os_atomic_store(&rb->_waiting, 0);
+        __OS_OWNED_EXIT_CRITICAL
+        return;
+    }
+
+    struct task_control_block *_current_task_tcb = os_get_current_task_tcb();
+    os_add_tick_task(_current_task_tcb, time_out, &rb->_block_obj);
+    __OS_OWNED_EXIT_CRITICAL
+    __os_sched();
+
+    // 该处是为了给软中断异常被触发前留足时间
+    while (os_task_is_block(_current_task_tcb)) {
+    };
+
+    __os_ringbuf_wait_finish(rb, _current_task_tcb);
+}
+
+/*
+ *@func: 初始化环形缓冲区, size 必须为2的幂
+ */
+os_handle_state_t os_ringbuf_init(struct os_ringbuf *rb, void *buf, unsigned int size)
+{
+    if (NULL == rb ||
+        NULL == buf ||
+        size < 2 ||
+        (size & (size - 1)))
+        return OS_HANDLE_FAIL;
+    rb->_buf = (unsigned char *)buf;
+    rb->_size = (os_base_t)size;
+    rb->_wr = 0;
+    rb->_rd = 0;
+    rb->_threshold = 1;
+    rb->_waiting = 0;
+    os_block_init(&rb->_block_obj, OS_BLOCK_RINGBUF);
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 设置唤醒阈值, 阻塞的消费者在数据量达到该值时才被唤醒
+ */
+os_handle_state_t os_ringbuf_set_threshold(struct os_ringbuf *rb, unsigned int threshold)
+{
+    if (NULL == rb ||
+        0 == threshold ||
+        threshold > (unsigned int)rb->_size)
+        return OS_HANDLE_FAIL;
+    rb->_threshold = (os_base_t)threshold;
+    return OS_HANDLE_SUCCESS;
+}
+
+inline unsigned int os_ringbuf_used(struct os_ringbuf *rb)
+{
+    return (unsigned int)os_atomic_load(&rb->_wr) - (unsigned int)os_atomic_load(&rb->_rd);
+}
+
+inline unsigned int os_ringbuf_free(struct os_ringbuf *rb)
+{
+    return (unsigned int)rb->_size - os_ringbuf_used(rb);
+}
+
+/*
+ *@func: 生产者写入数据, 返回实际写入的字节数, 空间不足时丢弃多余数据
+ *@note: 可在中断中调用, 不进入临界区, 同一时刻只允许一个生产者
+ */
+unsigned int os_ringbuf_push(struct os_ringbuf *rb, const void *buf, unsigned int len)
+{
+    if (NULL == rb || NULL == buf)
+        return 0;
+
+    unsigned int _wr = (unsigned int)rb->_wr;
+    unsigned int _free = (unsigned int)rb->_size - (_wr - (unsigned int)os_atomic_load(&rb->_rd));
+
+    if (len > _free)
+        len = _free;
+    if (0 == len)
+        return 0;
+    __os_ringbuf_copy_in(rb, _wr, (const unsigned char *)buf, len);
+    // 数据拷贝完成后才对消费者可见
+    os_atomic_store(&rb->_wr, (os_base_t)(_wr + len));
+
+    // 消费者等待且达到阈值时只唤醒一次
+    if (os_atomic_load(&rb->_waiting) &&
+        os_ringbuf_used(rb) >= (unsigned int)rb->_threshold &&
+        os_atomic_exchange(&rb->_waiting, 0) &&
+        os_int_post(OS_INT_POST_OBJ_RINGBUF_WAKEUP, rb, NULL, 0) != OS_HANDLE_SUCCESS)
+        // 投递队列已满, 恢复等待标志, 由下一次写入重新唤醒
+        os_atomic_store(&rb->_waiting, 1);
+    return len;
+}
+
+/*
+ *@func: 消费者读取至多 len 字节, 返回实际读取的字节数
+ *@note: 缓冲区中数据少于唤醒阈值时阻塞, 直到达到阈值或超时, 随后读取所有可用数据(可能少于阈值),
+ *       同一时刻只允许一个消费者
+ */
+unsigned int os_ringbuf_pop(struct os_ringbuf *rb, void *buf, unsigned int len, unsigned int time_out)
+{
+    if (NULL == rb ||
+        NULL == buf ||
+        0 == len)
+        return 0;
+
+    if (time_out != OS_RINGBUF_NO_WAIT &&
+        os_ringbuf_used(rb) < (unsigned int)rb->_threshold)
+        __os_ringbuf_wait(rb, time_out);
+
+    return __os_ringbuf_read(rb, buf, len);
+}
+
+/*
+ *@func: 由软中断处理 os_int_post 时调用, 唤醒等待的消费者
+ */
+void __os_int_post_ringbuf_wakeup(struct os_ringbuf *rb)
+{
+    if (NULL == rb)
+        return;
+    os_block_wakeup_first_task(&rb->_block_obj, __os_ringbuf_wakeup_task_cb);
+}
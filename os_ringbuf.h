@@ -0,0 +1,47 @@
+/***********************
+ * @file: os_ringbuf.h
+ * @author: Feijie Luo
+ * @Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     Feijie Luo   First version
+ * @note:
+ ***********************/
+
+#ifndef _OS_RINGBUF_H_
+#define _OS_RINGBUF_H_
+
+#include "os_block.h"
+#include "os_config.h"
+#include "os_def.h"
+
+#define OS_RINGBUF_NO_WAIT       (0)
+#define OS_RINGBUF_NEVER_TIMEOUT (OS_NEVER_TIME_OUT)
+
+/*
+ * 单生产者/单消费者无锁字节环形缓冲区.
+ * 生产者(通常为中断)写入与消费者(任务)读取均不进入临界区,
+ * 仅当消费者阻塞且数据量达到唤醒阈值时, 由生产者通过 os_int_post 唤醒一次消费者.
+ */
+struct os_ringbuf {
+    unsigned char *_buf;
+    // 缓冲区大小, 必须为2的幂
+    os_base_t _size;
+    // 写入与读取位置, 自由递增, 分别只由生产者与消费者修改
+    volatile os_base_t _wr;
+    volatile os_base_t _rd;
+    // 唤醒阈值
+    os_base_t _threshold;
+    // 消费者是否正在等待
+    volatile os_base_t _waiting;
+    struct os_block_object _block_obj;
+};
+
+os_handle_state_t os_ringbuf_init(struct os_ringbuf *rb, void *buf, unsigned int size);
+os_handle_state_t os_ringbuf_set_threshold(struct os_ringbuf *rb, unsigned int threshold);
+unsigned int os_ringbuf_push(struct os_ringbuf *rb, const void *buf, unsigned int len);
+unsigned int os_ringbuf_pop(struct os_ringbuf *rb, void *buf, unsigned int len, unsigned int time_out);
+unsigned int os_ringbuf_used(struct os_ringbuf *rb);
+unsigned int os_ringbuf_free(struct os_ringbuf *rb);
+void __os_int_post_ringbuf_wakeup(struct os_ringbuf *rb);
+
+#endif
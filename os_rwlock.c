@@ -0,0 +1,290 @@
+/***********************
+ * @file: os_rwlock.c
+ * @author: Feijie Luo
+ * @Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     Feijie Luo   First version
+ * @note:
+ ***********************/
+
+#include "os_block.h"
+#include "os_core.h"
+#include "os_rwlock.h"
+#include "os_sched.h"
+#include "os_tick.h"
+
+#include "board/libcpu_headfile.h"
+
+#include "stddef.h"
+
+os_private inline void __os_rwlock_wakeup_task_cb(struct task_control_block *tcb)
+{
+    // 将该任务从挂载的tick上摘掉
+    list_del_init(&(tcb->_bt_nd));
+}
+
+/*
+ *@func: 无写者持有且无写者等待时才允许获得读锁(写优先)
+ */
+os_private inline bool __os_rwlock_can_read(struct os_rwlock *rw)
+{
+    return (NULL == rw->_writer &&
+            os_block_list_is_empty(&rw->_wr_block_obj));
+}
+
+/*
+ *@func: 更新写锁拥有者的优先级, 使其不低于所有等待任务中的最高优先级
+ *@note: 阻塞链表按优先级排序, 表头即为该链表中优先级最高的任务
+ */
+os_private void __os_rwlock_writer_prio_update(struct os_rwlock *rw)
+{
+    struct task_control_block *_tcb = NULL;
+    unsigned int _prio;
+
+    if (NULL == rw->_writer)
+        return;
+    _prio = rw->_writer_prio;
+    if (!os_block_list_is_empty(&rw->_rd_block_obj)) {
+        _tcb = os_list_first_entry(&rw->_rd_block_obj._list, struct task_control_block, _slot_nd);
+        if (_tcb->_task_priority < _prio)
+            _prio = _tcb->_task_priority;
+    }
+    if (!os_block_list_is_empty(&rw->_wr_block_obj)) {
+        _tcb = os_list_first_entry(&rw->_wr_block_obj._list, struct task_control_block, _slot_nd);
+        if (_tcb->_task_priority < _prio)
+            _prio = _tcb->_task_priority;
+    }
+    os_rq_change_task_priority(rw->_writer, _prio);
+}
+
+/*
+ *@func: 释放写锁拥有者, 恢复其原来的优先级
+ */
+os_private inline void __os_rwlock_writer_release(struct os_rwlock *rw)
+{
+    os_rq_change_task_priority(rw->_writer, rw->_writer_prio);
+    rw->_writer = NULL;
+}
+
+/*
+ *@func: 将写锁直接移交给写等待队列中的第一个任务
+ *@note: 由唤醒方代为设置拥有者, 被唤醒的任务运行前写锁不会被其他任务抢占
+ */
+os_private void __os_rwlock_writer_handoff(struct os_rwlock *rw)
+{
+    struct task_control_block *_tcb =
+        os_list_first_entry(&rw->_wr_block_obj._list, struct task_control_block, _slot_nd);
+    os_block_wakeup_first_task(&rw->_wr_block_obj, __os_rwlock_wakeup_task_cb);
+    rw->_writer = _tcb;
+    rw->_writer_prio = _tcb->_task_priority;
+    __os_rwlock_writer_prio_update(rw);
+}
+
+/*
+ *@func: 唤醒读等待队列中的所有任务, 并代为增加读者计数
+ */
+os_private void __os_rwlock_readers_grant(struct os_rwlock *rw)
+{
+    while (!os_block_list_is_empty(&rw->_rd_block_obj)) {
+        os_block_wakeup_first_task(&rw->_rd_block_obj, __os_rwlock_wakeup_task_cb);
+        rw->_readers++;
+    }
+}
+
+/*
+ *@func: 初始化读写锁
+ */
+os_handle_state_t os_rwlock_init(struct os_rwlock *rw)
+{
+    if (NULL == rw)
+        return OS_HANDLE_FAIL;
+    rw->_writer = NULL;
+    rw->_writer_prio = OS_TASK_MAX_PRIORITY;
+    rw->_readers = 0;
+    os_block_init(&rw->_rd_block_obj, OS_BLOCK_RWLOCK);
+    os_block_init(&rw->_wr_block_obj, OS_BLOCK_RWLOCK);
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 销毁读写锁, 锁被持有或存在等待任务时失败
+ */
+os_handle_state_t os_rwlock_destory(struct os_rwlock *rw)
+{
+    if (NULL == rw)
+        return OS_HANDLE_FAIL;
+    __OS_OWNED_ENTER_CRITICAL
+    if (NULL != rw->_writer ||
+        rw->_readers > 0 ||
+        !os_block_list_is_empty(&rw->_rd_block_obj) ||
+        !os_block_list_is_empty(&rw->_wr_block_obj)) {
+        __OS_OWNED_EXIT_CRITICAL
+        return OS_HANDLE_FAIL;
+    }
+    os_block_deinit(&rw->_rd_block_obj);
+    os_block_deinit(&rw->_wr_block_obj);
+    __OS_OWNED_EXIT_CRITICAL
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 获取读锁
+ */
+os_handle_state_t os_rwlock_rdlock(struct os_rwlock *rw, unsigned int time_out)
+{
+    if (NULL == rw)
+        return OS_HANDLE_FAIL;
+
+    __OS_OWNED_ENTER_CRITICAL
+
+    struct task_control_block *_current_task_tcb = os_get_current_task_tcb();
+    // 写锁拥有者再次获取读锁将导致死锁
+    if (rw->_writer == _current_task_tcb) {
+        __OS_OWNED_EXIT_CRITICAL
+        return OS_HANDLE_FAIL;
+    }
+
+    if (!__os_rwlock_can_read(rw)) {
+        if (time_out == OS_RWLOCK_NO_WAIT) {
+            __OS_OWNED_EXIT_CRITICAL
+            return OS_HANDLE_FAIL;
+        }
+        // 将当前任务挂起, 并提高写锁拥有者的优先级
+        os_add_tick_task(_current_task_tcb, time_out, &rw->_rd_block_obj);
+        __os_rwlock_writer_prio_update(rw);
+        __OS_OWNED_EXIT_CRITICAL
+        __os_sched();
+
+        // 该处是为了给软中断异常被触发前留足时间
+        while (os_task_is_block(_current_task_tcb)) {
+        };
+
+        __OS_OWNED_ENTER_CRITICAL
+
+        // 超时
+        if (_current_task_tcb->_task_block_state == OS_TASK_BLOCK_TIMEOUT) {
+            _current_task_tcb->_task_block_state = OS_TASK_BLOCK_NONE;
+            __os_rwlock_writer_prio_update(rw);
+            __OS_OWNED_EXIT_CRITICAL
+            return OS_HANDLE_FAIL;
+        } else {
+            // 读者计数已由唤醒方代为增加
+            _current_task_tcb->_task_block_state = OS_TASK_BLOCK_NONE;
+            __OS_OWNED_EXIT_CRITICAL
+            return OS_HANDLE_SUCCESS;
+        }
+    }
+
+    rw->_readers++;
+    __OS_OWNED_EXIT_CRITICAL
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 获取写锁
+ */
+os_handle_state_t os_rwlock_wrlock(struct os_rwlock *rw, unsigned int time_out)
+{
+    if (NULL == rw)
+        return OS_HANDLE_FAIL;
+
+    __OS_OWNED_ENTER_CRITICAL
+
+    struct task_control_block *_current_task_tcb = os_get_current_task_tcb();
+    // 写锁不允许递归
+    if (rw->_writer == _current_task_tcb) {
+        __OS_OWNED_EXIT_CRITICAL
+        return OS_HANDLE_FAIL;
+    }
+
+    if (NULL != rw->_writer || rw->_readers > 0) {
+        if (time_out == OS_RWLOCK_NO_WAIT) {
+            __OS_OWNED_EXIT_CRITICAL
+            return OS_HANDLE_FAIL;
+        }
+        os_add_tick_task(_current_task_tcb, time_out, &rw->_wr_block_obj);
+        __os_rwlock_writer_prio_update(rw);
+        __OS_OWNED_EXIT_CRITICAL
+        __os_sched();
+
+        while (os_task_is_block(_current_task_tcb)) {
+        };
+
+        __OS_OWNED_ENTER_CRITICAL
+
+        if (_current_task_tcb->_task_block_state == OS_TASK_BLOCK_TIMEOUT) {
+            _current_task_tcb->_task_block_state = OS_TASK_BLOCK_NONE;
+            // 最后一个等待的写者超时退出后, 被写优先阻塞的读者可以获得读锁
+            if (__os_rwlock_can_read(rw))
+                __os_rwlock_readers_grant(rw);
+            __os_rwlock_writer_prio_update(rw);
+            __OS_OWNED_EXIT_CRITICAL
+            __os_sched();
+            return OS_HANDLE_FAIL;
+        } else {
+            // 写锁已由唤醒方移交
+            _current_task_tcb->_task_block_state = OS_TASK_BLOCK_NONE;
+            __OS_OWNED_EXIT_CRITICAL
+            return OS_HANDLE_SUCCESS;
+        }
+    }
+
+    rw->_writer = _current_task_tcb;
+    rw->_writer_prio = _current_task_tcb->_task_priority;
+    __OS_OWNED_EXIT_CRITICAL
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 释放读锁, 最后一个读者退出时将写锁移交给等待的写者
+ */
+os_handle_state_t os_rwlock_rdunlock(struct os_rwlock *rw)
+{
+    if (NULL == rw)
+        return OS_HANDLE_FAIL;
+
+    __OS_OWNED_ENTER_CRITICAL
+
+    if (0 == rw->_readers) {
+        __OS_OWNED_EXIT_CRITICAL
+        return OS_HANDLE_FAIL;
+    }
+
+    if (--rw->_readers > 0 ||
+        os_block_list_is_empty(&rw->_wr_block_obj)) {
+        __OS_OWNED_EXIT_CRITICAL
+        return OS_HANDLE_SUCCESS;
+    }
+
+    __os_rwlock_writer_handoff(rw);
+    __OS_OWNED_EXIT_CRITICAL
+    __os_sched();
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 释放写锁, 优先移交给等待的写者, 否则唤醒所有等待的读者
+ */
+os_handle_state_t os_rwlock_wrunlock(struct os_rwlock *rw)
+{
+    if (NULL == rw)
+        return OS_HANDLE_FAIL;
+
+    __OS_OWNED_ENTER_CRITICAL
+
+    if (rw->_writer != os_get_current_task_tcb()) {
+        __OS_OWNED_EXIT_CRITICAL
+        return OS_HANDLE_FAIL;
+    }
+
+    __os_rwlock_writer_release(rw);
+
+    if (!os_block_list_is_empty(&rw->_wr_block_obj))
+        __os_rwlock_writer_handoff(rw);
+    else
+        __os_rwlock_readers_grant(rw);
+
+    __OS_OWNED_EXIT_CRITICAL
+    __os_sched();
+    return OS_HANDLE_SUCCESS;
+}
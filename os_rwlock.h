@@ -0,0 +1,42 @@
+/***********************
+ * @file: os_rwlock.h
+ * @author: Feijie Luo
+ * @Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     Feijie Luo   First version
+ * @note:
+ ***********************/
+
+#ifndef _OS_RWLOCK_H_
+#define _OS_RWLOCK_H_
+
+#include "os_config.h"
+#include "os_core.h"
+#include "os_block.h"
+
+#define OS_RWLOCK_NO_WAIT       (0)
+#define OS_RWLOCK_NEVER_TIMEOUT (OS_NEVER_TIME_OUT)
+
+/*
+ * 读写锁: 允许多个读者并发持有, 写者独占.
+ * 写优先: 一旦存在等待的写者, 新的读者将被阻塞, 以防止写者饥饿.
+ * 优先级继承仅作用于写锁持有者.
+ */
+typedef struct os_rwlock {
+    // 等待读锁的任务
+    struct os_block_object _rd_block_obj;
+    // 等待写锁的任务
+    struct os_block_object _wr_block_obj;
+    struct task_control_block *_writer;
+    unsigned int _writer_prio;
+    unsigned int _readers;
+} os_rwlock_t;
+
+os_handle_state_t os_rwlock_init(struct os_rwlock *rw);
+os_handle_state_t os_rwlock_destory(struct os_rwlock *rw);
+os_handle_state_t os_rwlock_rdlock(struct os_rwlock *rw, unsigned int time_out);
+os_handle_state_t os_rwlock_wrlock(struct os_rwlock *rw, unsigned int time_out);
+os_handle_state_t os_rwlock_rdunlock(struct os_rwlock *rw);
+os_handle_state_t os_rwlock_wrunlock(struct os_rwlock *rw);
+
+#endif
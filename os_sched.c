@@ -4,6 +4,8 @@
  * @Change Logs:
  * Date           Author       Notes
  * 2022-09-10     Feijie Luo   First version
+ * 2026-10-19     Feijie Luo   Add os_rq_change_task_priority
+ * 2026-10-19     Feijie Luo   Export os_ffb
  * @note:
  ***********************/
 
@@ -79,6 +81,12 @@ os_private unsigned int __ffb(unsigned int _word)
     return _lowest_bitmap[(_word & 0xFF000000) >> 24] + 24;
 }
 
+/* 获取最低的置位位号, _word 为0时返回0 */
+unsigned int os_ffb(unsigned int _word)
+{
+    return __ffb(_word);
+}
+
 /* 从bitmap中获取最高优先级(数值越小，优先级越高) */
 inline unsigned char __get_highest_ready_priority(void)
 {
@@ -153,6 +161,23 @@ void os_rq_del_task(struct task_control_block *_task)
     }
 }
 
+/*
+ *@func: 修改任务优先级
+ *@note: 若任务处在就绪队列中(ready/running)则按新优先级重新挂载, 任务状态保持不变
+ */
+void os_rq_change_task_priority(struct task_control_block *_task, unsigned char _prio)
+{
+    if (_task->_task_priority == _prio)
+        return;
+    if (os_task_state_is_ready(_task) ||
+        os_task_state_is_running(_task)) {
+        os_rq_del_task(_task);
+        _task->_task_priority = _prio;
+        __os_rq_add_task_tail(_task);
+    } else
+        _task->_task_priority = _prio;
+}
+
 /* 获取就绪队列中的任务最高优先级 */
 struct task_control_block *os_rq_get_highest_prio_task(void)
 {
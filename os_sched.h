@@ -4,6 +4,7 @@
  * @Change Logs:
  * Date           Author       Notes
  * 2022-09-10     Feijie Luo   First version
+ * 2026-10-19     Feijie Luo   Export os_ffb
  * @note:
  ***********************/
 
@@ -30,6 +31,8 @@ void update_ready_queue_priority(void);
 unsigned char __get_highest_ready_priority(void);
 void os_rq_add_task(struct task_control_block *_task);
 void os_rq_del_task(struct task_control_block *_task);
+void os_rq_change_task_priority(struct task_control_block *_task, unsigned char _prio);
+unsigned int os_ffb(unsigned int _word);
 struct task_control_block *os_rq_get_highest_prio_task(void);
 void os_sys_ready_queue_init(void);
 os_handle_state_t os_sched_lock(void);
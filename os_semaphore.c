@@ -4,6 +4,7 @@
  * @Change Logs:
  * Date           Author       Notes
  * 2023-10-19     Feijie Luo   First version
+ * 2026-10-19     Feijie Luo   Support OS_SEM_NO_WAIT. Notify os_wait_multiple waiters
  * @note:
  ***********************/
 
@@ -12,6 +13,7 @@
 #include "os_sched.h"
 #include "os_semaphore.h"
 #include "os_tick.h"
+#include "os_wait.h"
 #include "stddef.h"
 
 os_handle_state_t os_sem_init(struct os_sem *sem, unsigned short value)
@@ -39,6 +41,9 @@ os_handle_state_t os_sem_take(struct os_sem *sem, unsigned int time_out)
         sem->_value--;
         __OS_OWNED_EXIT_CRITICAL
         return OS_HANDLE_SUCCESS;
+    } else if (time_out == OS_SEM_NO_WAIT) {
+        __OS_OWNED_EXIT_CRITICAL
+        return OS_HANDLE_FAIL;
     } else {
         struct task_control_block *_current_task_tcb = os_get_current_task_tcb();
         // 将当前任务挂起
@@ -76,9 +81,10 @@ os_handle_state_t os_sem_release(struct os_sem *sem)
         return OS_HANDLE_FAIL;
     __OS_OWNED_ENTER_CRITICAL
 
-    if (list_empty(&(sem->_block_obj._list)))
+    if (list_empty(&(sem->_block_obj._list))) {
         sem->_value++;
-    else
+        os_wait_notify(&sem->_block_obj);
+    } else
         os_block_wakeup_first_task(&sem->_block_obj, __os_sem_release_cb);
 
     __OS_OWNED_EXIT_CRITICAL
@@ -91,8 +97,9 @@ void __os_int_post_sem_release(struct os_sem *sem)
     if (NULL == sem)
         return;
 
-    if (list_empty(&(sem->_block_obj._list)))
+    if (list_empty(&(sem->_block_obj._list))) {
         sem->_value++;
-    else
+        os_wait_notify(&sem->_block_obj);
+    } else
         os_block_wakeup_first_task(&sem->_block_obj, __os_sem_release_cb);
 }
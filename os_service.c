@@ -7,16 +7,20 @@
  * 2023-10-24     Feijie Luo   Add Fish(Friendly Interactive SHell) service
  * 2023-10-31     Feijie Luo   Fix cmd's size bug in
  *                                cmd_call_ptr cmd_call = __os_get_cmd_call(argv[0], strlen(cmd));
+ * 2026-10-19     Feijie Luo   Deliver step input keys through an os_stream
+ * 2026-10-19     Feijie Luo   Take history nodes from fixed-size pools
  * @note:
  ***********************/
 
 #include "board/libcpu_headfile.h"
 #include "board/os_board.h"
 #include "components/memory/os_malloc.h"
+#include "components/memory/os_mempool.h"
 #include "os_core.h"
 #include "os_device.h"
 #include "os_list.h"
 #include "os_mqueue.h"
+#include "os_stream.h"
 #include "os_sched.h"
 #include "os_service.h"
 #include "stdarg.h"
@@ -38,11 +42,16 @@ struct os_fish_inp_nd {
 static LIST_HEAD(__os_service_tin_list);
 static struct list_head* __os_service_tin_list_tail;
 static unsigned char __os_service_tin_list_len;
+// History nodes and inputs, one more input is held by the terminal thread while receiving.
+OS_MEMPOOL_DEFINE(__os_fish_inp_nd_pool, struct os_fish_inp_nd, OS_SERVICE_FISH_MSG_LIST_CAP);
+OS_MEMPOOL_DEFINE(__os_fish_inp_pool, struct os_service_fish_input, OS_SERVICE_FISH_MSG_LIST_CAP + 1);
 
 // Every complete command(End with the 'CR (Carriage Return)' key) can be sent to this mq.
 static struct os_mqueue __os_fish_inp_mq;
-// Every typed key can be sent to this mq.
-static struct os_mqueue __os_fish_step_inp_mq;
+// Every typed key is written to this stream.
+#define FISH_STEP_INPUT_BUF_SIZE (64)
+static struct os_stream __os_fish_step_inp_stream;
+static unsigned char __os_fish_step_inp_buf[FISH_STEP_INPUT_BUF_SIZE];
 
 // Callback functions used to handle input keys.
 static fish_irq_handle fish_irq_handle_vector[FISH_IRQ_HANDLE_SIZE];
@@ -538,15 +547,15 @@ os_private void __tin_list_add_tail(struct os_service_fish_input *inp)
         // Free the 'first' one, the head of the queue.
         struct os_fish_inp_nd *tmp =
             os_list_entry(__os_service_tin_list.next, struct os_fish_inp_nd, list_nd);
-        os_kfree(tmp->data_pack);
+        os_mempool_free(&__os_fish_inp_pool, tmp->data_pack);
         list_del(&tmp->list_nd);
-        os_kfree(tmp);
+        os_mempool_free(&__os_fish_inp_nd_pool, tmp);
         __os_service_tin_list_len--;
     }
 
     // Add a new one to the tail of queue.
     struct os_fish_inp_nd *nd =
-        (struct os_fish_inp_nd *)os_kmalloc(sizeof(struct os_fish_inp_nd));
+        (struct os_fish_inp_nd *)os_mempool_alloc(&__os_fish_inp_nd_pool);
     OS_ASSERT(NULL != nd);
     nd->data_pack = inp;
     list_add_tail(&__os_service_tin_list, &nd->list_nd);
@@ -563,17 +572,19 @@ os_private void __tin_list_clear(void)
         struct os_fish_inp_nd *tmp =
             os_list_entry(current_pos, struct os_fish_inp_nd, list_nd);
         list_del_init(&tmp->list_nd);
-        os_kfree(tmp->data_pack);
-        os_kfree(tmp);
+        os_mempool_free(&__os_fish_inp_pool, tmp->data_pack);
+        os_mempool_free(&__os_fish_inp_nd_pool, tmp);
         __os_service_tin_list_len--;
     }
 }
 
 static void __kthread_terminal(void *_arg)
 {
-    struct os_service_fish_input *_inp;
+    struct os_service_fish_input *_inp = NULL;
     while (1) {
-        _inp = (struct os_service_fish_input *)os_kmalloc(sizeof(struct os_service_fish_input));
+        // The input is reused until it is kept in the history list.
+        if (NULL == _inp)
+            _inp = (struct os_service_fish_input *)os_mempool_alloc(&__os_fish_inp_pool);
         OS_ASSERT(NULL != _inp);
         if (OS_HANDLE_SUCCESS ==
             os_mqueue_receive(os_get_fish_input_mq(), (void *)_inp,
@@ -582,6 +593,7 @@ static void __kthread_terminal(void *_arg)
             int ret_val;
             if (os_exec_cmd(_inp->data, _inp->size, &ret_val) == OS_HANDLE_SUCCESS) {
                 __tin_list_add_tail(_inp);
+                _inp = NULL;
                 // os_printk(":Command return value:%d\r\n", ret_val);
             }
             os_printk("esh>");
@@ -689,11 +701,9 @@ os_handle_state_t os_fish_irq_handle_callback(unsigned int rec)
 
 os_private os_handle_state_t __os_fish_irq_handle_step_fn(unsigned int rec)
 {
-    static unsigned char get_rec_buff[20];
-    static os_base_t get_rec_index;
-    os_base_t reserve_pos = os_atomic_add_bge_set_strong(&get_rec_index, 1, 20, 0);
-    get_rec_buff[reserve_pos] = rec;
-    os_int_post(OS_INT_POST_OBJ_MQUEUE_SEND, os_get_fish_step_input_mq(), &get_rec_buff[reserve_pos], sizeof(unsigned char));
+    unsigned char _ch = (unsigned char)rec;
+    if (os_stream_write(os_get_fish_step_input_stream(), &_ch, sizeof(unsigned char)) == 0)
+        return OS_HANDLE_FAIL;
     return OS_HANDLE_SUCCESS;
 }
 
@@ -770,10 +780,10 @@ inline struct os_mqueue *os_get_fish_input_mq(void)
 #endif
 }
 
-inline struct os_mqueue *os_get_fish_step_input_mq(void)
+inline struct os_stream *os_get_fish_step_input_stream(void)
 {
 #ifdef CONFIG_FISH
-    return &__os_fish_step_inp_mq;
+    return &__os_fish_step_inp_stream;
 #else
     return NULL;
 #endif
@@ -790,7 +800,7 @@ void os_service_init(void)
     cmd_addr_end = (struct os_fish_cmd_structure *)&__os_fish_cmd_table_end;
 #endif
     os_mqueue_init(&__os_fish_inp_mq, 5, sizeof(struct os_service_fish_input));
-    os_mqueue_init(&__os_fish_step_inp_mq, 10, sizeof(struct os_service_fish_input));
+    os_stream_init(&__os_fish_step_inp_stream, __os_fish_step_inp_buf, FISH_STEP_INPUT_BUF_SIZE, 1);
     fish_irq_handle_vector[OS_FISH_IRQ_HANDLE_NONE] = NULL;
     fish_irq_handle_vector[OS_FISH_IRQ_HANDLE_DEFAULT] = __os_fish_irq_handle_default_fn;
     fish_irq_handle_vector[OS_FISH_IRQ_HANDLE_STEP] = __os_fish_irq_handle_step_fn;
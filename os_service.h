@@ -39,7 +39,7 @@ os_handle_state_t os_fish_irq_handle_callback(unsigned int rec);
 bool os_fish_change_irq_handle(enum os_fish_irq_handle new_handle);
 enum os_fish_irq_handle os_fish_get_now_irq_handle(void);
 struct os_mqueue *os_get_fish_input_mq(void);
-struct os_mqueue *os_get_fish_step_input_mq(void);
+struct os_stream *os_get_fish_step_input_stream(void);
 void os_service_init(void);
 
 #ifdef CONFIG_FISH
@@ -0,0 +1,99 @@
+/***********************
+ * @file: os_stream.c
+ * @author: Feijie Luo
+ * @Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     Feijie Luo   First version
+ * @note:
+ ***********************/
+
+#include "os_stream.h"
+
+#include "board/libcpu_headfile.h"
+
+#include "stddef.h"
+
+/*
+ *@func: 初始化字节流, size 必须为2的幂, trigger 为阻塞读取者的默认触发水平
+ */
+os_handle_state_t os_stream_init(struct os_stream *s, void *buf, unsigned int size, unsigned int trigger)
+{
+    if (NULL == s ||
+        0 == trigger ||
+        trigger > size)
+        return OS_HANDLE_FAIL;
+    if (OS_HANDLE_SUCCESS != os_ringbuf_init(&s->_rb, buf, size))
+        return OS_HANDLE_FAIL;
+    s->_trigger = trigger;
+    return OS_HANDLE_SUCCESS;
+}
+
+os_handle_state_t os_stream_set_trigger(struct os_stream *s, unsigned int trigger)
+{
+    if (NULL == s ||
+        0 == trigger ||
+        trigger > (unsigned int)s->_rb._size)
+        return OS_HANDLE_FAIL;
+    s->_trigger = trigger;
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 写入至多 n 字节, 返回实际写入的字节数, 空间不足时丢弃多余数据
+ *@note: 可在任务或中断中调用, 写入期间关闭中断, 因此允许多个写入者
+ */
+unsigned int os_stream_write(struct os_stream *s, const void *buf, unsigned int n)
+{
+    unsigned int _ret;
+
+    if (NULL == s || NULL == buf || 0 == n)
+        return 0;
+    OS_ENTER_CRITICAL
+    _ret = os_ringbuf_push(&s->_rb, buf, n);
+    OS_EXIT_CRITICAL
+    return _ret;
+}
+
+/*
+ *@func: 读取至多 n 字节, 返回实际读取的字节数
+ *@note: 可读数据少于 min 字节时阻塞, 直到累计读取 min 字节或超时;
+ *       min 为0时使用触发水平, 超时返回已读取的字节数(可能少于 min)
+ */
+unsigned int os_stream_read(struct os_stream *s, void *buf, unsigned int n,
+                            unsigned int min, unsigned int time_out)
+{
+    unsigned int _total;
+
+    if (NULL == s || NULL == buf || 0 == n)
+        return 0;
+    if (0 == min)
+        min = s->_trigger;
+    if (min > n)
+        min = n;
+    if (min > (unsigned int)s->_rb._size)
+        min = (unsigned int)s->_rb._size;
+
+    _total = os_ringbuf_pop(&s->_rb, buf, n, OS_RINGBUF_NO_WAIT);
+    if (_total >= min || time_out == OS_STREAM_NO_WAIT)
+        return _total;
+
+    // 只在还差的字节全部到达后唤醒一次
+    os_ringbuf_set_threshold(&s->_rb, min - _total);
+    _total += os_ringbuf_pop(&s->_rb, (unsigned char *)buf + _total, n - _total, time_out);
+    return _total;
+}
+
+inline unsigned int os_stream_available(struct os_stream *s)
+{
+    return os_ringbuf_used(&s->_rb);
+}
+
+/*
+ *@func: 丢弃所有未读取的数据, 只允许读取者调用
+ */
+void os_stream_reset(struct os_stream *s)
+{
+    if (NULL == s)
+        return;
+    os_atomic_store(&s->_rb._rd, os_atomic_load(&s->_rb._wr));
+}
@@ -0,0 +1,39 @@
+/***********************
+ * @file: os_stream.h
+ * @author: Feijie Luo
+ * @Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     Feijie Luo   First version
+ * @note:
+ ***********************/
+
+#ifndef _OS_STREAM_H_
+#define _OS_STREAM_H_
+
+#include "os_config.h"
+#include "os_def.h"
+#include "os_ringbuf.h"
+
+#define OS_STREAM_NO_WAIT       (OS_RINGBUF_NO_WAIT)
+#define OS_STREAM_NEVER_TIMEOUT (OS_RINGBUF_NEVER_TIMEOUT)
+
+/*
+ * 字节流缓冲区, 用于传递变长数据(如串口接收).
+ * 写入可在任务或中断中进行, 同一时刻只允许一个读取者.
+ * 阻塞的读取者在缓冲区中的数据达到触发水平后才被唤醒, 而不是每个字节唤醒一次.
+ */
+struct os_stream {
+    struct os_ringbuf _rb;
+    // 读取者的默认触发水平
+    unsigned int _trigger;
+};
+
+os_handle_state_t os_stream_init(struct os_stream *s, void *buf, unsigned int size, unsigned int trigger);
+os_handle_state_t os_stream_set_trigger(struct os_stream *s, unsigned int trigger);
+unsigned int os_stream_write(struct os_stream *s, const void *buf, unsigned int n);
+unsigned int os_stream_read(struct os_stream *s, void *buf, unsigned int n,
+                            unsigned int min, unsigned int time_out);
+unsigned int os_stream_available(struct os_stream *s);
+void os_stream_reset(struct os_stream *s);
+
+#endif
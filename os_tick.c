@@ -7,6 +7,7 @@
  * 2023-10-13     Feijie Luo   Fix __os_tick_add_node function bug:
  *                                    The _tick_count for the linked list is not updated.
  * 2023-10-15     Feijie Luo   Improve program structure. tick inheritance block
+ * 2026-10-19     Feijie Luo   Take tick nodes from a fixed-size pool
  * @note:
  ***********************/
 
@@ -18,8 +19,29 @@
 
 #include "board/libcpu_headfile.h"
 #include "components/memory/os_malloc.h"
+#include "components/memory/os_mempool.h"
 
 LIST_HEAD(_os_tick_list_head);
+OS_MEMPOOL_DEFINE(_os_tick_pool, struct os_tick, CONFIG_OS_TICK_POOL_NUM);
+
+/*
+ *@func: 分配tick节点, 对象池耗尽时从内核堆中分配
+ */
+os_private inline struct os_tick *__os_tick_alloc(void)
+{
+    struct os_tick *_tick = (struct os_tick *)os_mempool_alloc(&_os_tick_pool);
+    if (NULL == _tick)
+        _tick = (struct os_tick *)os_kmalloc(sizeof(struct os_tick));
+    return _tick;
+}
+
+os_private inline void __os_tick_free(struct os_tick *_tick)
+{
+    if (os_mempool_owns(&_os_tick_pool, _tick))
+        os_mempool_free(&_os_tick_pool, _tick);
+    else
+        os_kfree(_tick);
+}
 
 os_private void __os_tick_add_node(struct task_control_block *_task_tcb, unsigned int _tick)
 {
@@ -45,7 +67,7 @@ os_private void __os_tick_add_node(struct task_control_block *_task_tcb, unsigne
         }
         _prev_tick = _current_tick;
     }
-    struct os_tick *new_tick = os_kmalloc(sizeof(struct os_tick));
+    struct os_tick *new_tick = __os_tick_alloc();
     OS_ASSERT(NULL != new_tick);
     new_tick->_tick_state = OS_TICK_RUNNING;
     new_tick->_tick_count = _tick - _prev_tick;
@@ -61,7 +83,7 @@ os_private void __os_tick_add_node(struct task_control_block *_task_tcb, unsigne
 os_private void __os_tick_del_node(struct os_tick *ptr_tick)
 {
     list_del_init(&(ptr_tick->_tick_list_nd));
-    os_kfree(ptr_tick);
+    __os_tick_free(ptr_tick);
 }
 
 os_handle_state_t os_add_tick_task(struct task_control_block *_task_tcb, unsigned int _tick,
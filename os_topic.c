@@ -0,0 +1,307 @@
+/***********************
+ * @file: os_topic.c
+ * @author: Feijie Luo
+ * @Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     Feijie Luo   First version
+ * 2026-10-19     Feijie Luo   Publish from interrupts through os_int_post
+ * 2026-10-19     Feijie Luo   Require a power-of-two capacity so slots survive sequence wrap
+ * 2026-10-19     Feijie Luo   Fix slot size overflow for samples near 64KB
+ * @note:
+ ***********************/
+
+#include "os_block.h"
+#include "os_core.h"
+#include "os_sched.h"
+#include "os_tick.h"
+#include "os_topic.h"
+
+#include "board/libcpu_headfile.h"
+#include "components/lib/os_string.h"
+#include "components/memory/os_malloc.h"
+
+#include "stddef.h"
+
+// 样本槽头部, 序号用于检测读取期间样本是否被覆盖
+struct topic_slot {
+    unsigned int _seq;
+    unsigned short _size;
+    unsigned short _reserved;
+};
+
+os_private inline void __os_topic_wakeup_task_cb(struct task_control_block *tcb)
+{
+    // 将该任务从挂载的tick上摘掉
+    list_del_init(&(tcb->_bt_nd));
+}
+
+os_private inline struct topic_slot *__os_topic_slot(struct os_topic *topic, unsigned int seq)
+{
+    // 容量为2的幂, 序号回绕后仍映射到连续的样本槽
+    return (struct topic_slot *)(topic->_pool + (seq & (topic->_capacity - 1U)) * topic->_slot_size);
+}
+
+/*
+ *@func: 订阅者落后超过一圈时, 跳到最旧的未被覆盖的样本并记录丢失数
+ */
+os_private inline void __os_topic_catch_up(struct os_topic_sub *sub)
+{
+    struct os_topic *_topic = sub->_topic;
+    unsigned int _behind = _topic->_seq - sub->_cursor;
+
+    if (_behind > _topic->_capacity) {
+        sub->_lost += _behind - _topic->_capacity;
+        sub->_cursor = _topic->_seq - _topic->_capacity;
+    }
+}
+
+/*
+ *@func: 拷贝完成后确认样本未被覆盖, 确认成功则移动游标
+ */
+os_private bool __os_topic_consume(struct os_topic_sub *sub, struct topic_slot *slot, unsigned int seq)
+{
+    bool _ok;
+
+    __OS_OWNED_ENTER_CRITICAL
+    _ok = (slot->_seq == seq && sub->_cursor == seq);
+    if (_ok)
+        sub->_cursor++;
+    __OS_OWNED_EXIT_CRITICAL
+    return _ok;
+}
+
+/*
+ *@func: 等待被唤醒或超时, 在临界区外调用
+ */
+os_private os_handle_state_t __os_topic_wait(struct task_control_block *_current_task_tcb)
+{
+    os_handle_state_t _ret = OS_HANDLE_SUCCESS;
+
+    __os_sched();
+    // 该处是为了给软中断异常被触发前留足时间
+    while (os_task_is_block(_current_task_tcb)) {
+    };
+
+    __OS_OWNED_ENTER_CRITICAL
+    if (_current_task_tcb->_task_block_state == OS_TASK_BLOCK_TIMEOUT)
+        _ret = OS_HANDLE_FAIL;
+    _current_task_tcb->_task_block_state = OS_TASK_BLOCK_NONE;
+    __OS_OWNED_EXIT_CRITICAL
+    return _ret;
+}
+
+/*
+ *@func: 写入一个样本并唤醒所有等待的订阅者, 在临界区内调用
+ */
+os_private void __os_topic_write(struct os_topic *topic, const void *buffer, unsigned short msize)
+{
+    struct topic_slot *_slot = __os_topic_slot(topic, topic->_seq);
+    os_memcpy((void *)(_slot + 1), buffer, msize);
+    _slot->_size = msize;
+    _slot->_seq = topic->_seq;
+    topic->_seq++;
+    while (!os_block_list_is_empty(&topic->_block_obj))
+        os_block_wakeup_first_task(&topic->_block_obj, __os_topic_wakeup_task_cb);
+}
+
+os_private void __os_topic_setup(struct os_topic *topic, void *pool, bool owned,
+                                 unsigned short mnum, unsigned short msize)
+{
+    topic->_msg_size = msize;
+    topic->_capacity = mnum;
+    topic->_slot_size = OS_TOPIC_SLOT_SIZE(msize);
+    topic->_pool_owned = owned;
+    topic->_seq = 0;
+    topic->_pool = (unsigned char *)pool;
+    for (unsigned int _i = 0; _i < mnum; ++_i) {
+        __os_topic_slot(topic, _i)->_seq = 0;
+        __os_topic_slot(topic, _i)->_size = 0;
+    }
+    list_head_init(&topic->_sub_list);
+    os_block_init(&topic->_block_obj, OS_BLOCK_TOPIC);
+}
+
+/*
+ *@func: 初始化主题, 样本环一次性从内核堆中分配
+ *@note: mnum 必须为2的幂
+ */
+os_handle_state_t os_topic_init(struct os_topic *topic, unsigned short mnum, unsigned short msize)
+{
+    if (NULL == topic ||
+        0 == mnum ||
+        (mnum & (mnum - 1)) ||
+        0 == msize ||
+        OS_TOPIC_SLOT_SIZE((unsigned int)msize) > ~0U / mnum)
+        return OS_HANDLE_FAIL;
+    void *_pool = os_kmalloc(OS_TOPIC_POOL_SIZE((unsigned int)mnum, (unsigned int)msize));
+    if (NULL == _pool)
+        return OS_HANDLE_FAIL;
+    __os_topic_setup(topic, _pool, true, mnum, msize);
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 使用调用者提供的存储空间初始化主题
+ *@note: pool 需4字节对齐, 大小不小于 OS_TOPIC_POOL_SIZE(mnum, msize), mnum 必须为2的幂
+ */
+os_handle_state_t os_topic_init_static(struct os_topic *topic,
+                                       void *pool, unsigned int pool_size,
+                                       unsigned short mnum, unsigned short msize)
+{
+    if (NULL == topic ||
+        NULL == pool ||
+        ((unsigned int)pool & 3) ||
+        0 == mnum ||
+        (mnum & (mnum - 1)) ||
+        0 == msize ||
+        OS_TOPIC_SLOT_SIZE((unsigned int)msize) > ~0U / mnum ||
+        pool_size < OS_TOPIC_POOL_SIZE((unsigned int)mnum, (unsigned int)msize))
+        return OS_HANDLE_FAIL;
+    __os_topic_setup(topic, pool, false, mnum, msize);
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 销毁主题, 仍有订阅者时失败
+ */
+os_handle_state_t os_topic_destory(struct os_topic *topic)
+{
+    if (NULL == topic)
+        return OS_HANDLE_FAIL;
+    __OS_OWNED_ENTER_CRITICAL
+    if (!list_empty(&topic->_sub_list) ||
+        !os_block_list_is_empty(&topic->_block_obj)) {
+        __OS_OWNED_EXIT_CRITICAL
+        return OS_HANDLE_FAIL;
+    }
+    void *_pool = topic->_pool_owned ? topic->_pool : NULL;
+    topic->_pool = NULL;
+    topic->_capacity = 0;
+    os_block_deinit(&topic->_block_obj);
+    __OS_OWNED_EXIT_CRITICAL
+    if (NULL != _pool)
+        os_kfree(_pool);
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 订阅主题, 订阅者只会收到订阅之后发布的样本
+ */
+os_handle_state_t os_topic_subscribe(struct os_topic *topic, struct os_topic_sub *sub)
+{
+    if (NULL == topic || NULL == sub)
+        return OS_HANDLE_FAIL;
+    __OS_OWNED_ENTER_CRITICAL
+    sub->_topic = topic;
+    sub->_cursor = topic->_seq;
+    sub->_lost = 0;
+    list_add_tail(&topic->_sub_list, &sub->_nd);
+    __OS_OWNED_EXIT_CRITICAL
+    return OS_HANDLE_SUCCESS;
+}
+
+os_handle_state_t os_topic_unsubscribe(struct os_topic_sub *sub)
+{
+    if (NULL == sub || NULL == sub->_topic)
+        return OS_HANDLE_FAIL;
+    __OS_OWNED_ENTER_CRITICAL
+    list_del_init(&sub->_nd);
+    sub->_topic = NULL;
+    __OS_OWNED_EXIT_CRITICAL
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 发布一个样本, 不阻塞, 唤醒所有等待的订阅者
+ *@note: 只能在任务中调用, 中断中使用 os_int_post(OS_INT_POST_OBJ_TOPIC_PUBLISH, ...)
+ */
+os_handle_state_t os_topic_publish(struct os_topic *topic, const void *buffer, unsigned short msize)
+{
+    if (NULL == topic ||
+        NULL == buffer ||
+        0 == msize ||
+        msize > topic->_msg_size)
+        return OS_HANDLE_FAIL;
+
+    __OS_OWNED_ENTER_CRITICAL
+    __os_topic_write(topic, buffer, msize);
+    __OS_OWNED_EXIT_CRITICAL
+    __os_sched();
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 由软中断处理 os_int_post 时调用, 在中断中发布样本
+ *@note: buffer 在被处理前必须保持有效
+ */
+void __os_int_post_topic_publish(struct os_topic *topic, const void *buffer, unsigned short msize)
+{
+    if (NULL == topic ||
+        NULL == buffer ||
+        0 == msize ||
+        msize > topic->_msg_size)
+        return;
+    __os_topic_write(topic, buffer, msize);
+}
+
+/*
+ *@func: 读取订阅者的下一个样本, 至多拷贝 msize 字节
+ *@note: 拷贝在临界区外进行, 若拷贝期间样本被覆盖则重新读取(此时已落后一圈, 会记录丢失数)
+ */
+os_handle_state_t os_topic_receive(struct os_topic_sub *sub,
+                                   void *buffer, unsigned short msize,
+                                   unsigned int time_out)
+{
+    if (NULL == sub ||
+        NULL == sub->_topic ||
+        NULL == buffer ||
+        0 == msize)
+        return OS_HANDLE_FAIL;
+
+    struct os_topic *_topic = sub->_topic;
+
+    for (;;) {
+        __OS_OWNED_ENTER_CRITICAL
+
+        if (sub->_cursor != _topic->_seq) {
+            __os_topic_catch_up(sub);
+            unsigned int _seq = sub->_cursor;
+            struct topic_slot *_slot = __os_topic_slot(_topic, _seq);
+            unsigned short _size = _slot->_size < msize ? _slot->_size : msize;
+            __OS_OWNED_EXIT_CRITICAL
+
+            os_memcpy(buffer, (const void *)(_slot + 1), _size);
+            if (__os_topic_consume(sub, _slot, _seq))
+                return OS_HANDLE_SUCCESS;
+            continue;
+        }
+
+        if (time_out == OS_TOPIC_NO_WAIT) {
+            __OS_OWNED_EXIT_CRITICAL
+            return OS_HANDLE_FAIL;
+        }
+
+        struct task_control_block *_current_task_tcb = os_get_current_task_tcb();
+        os_add_tick_task(_current_task_tcb, time_out, &_topic->_block_obj);
+        __OS_OWNED_EXIT_CRITICAL
+
+        if (OS_HANDLE_FAIL == __os_topic_wait(_current_task_tcb))
+            return OS_HANDLE_FAIL;
+    }
+}
+
+/*
+ *@func: 返回并清零订阅者因落后而丢失的样本数
+ */
+unsigned int os_topic_sub_lost(struct os_topic_sub *sub)
+{
+    unsigned int _lost;
+
+    if (NULL == sub)
+        return 0;
+    __OS_OWNED_ENTER_CRITICAL
+    _lost = sub->_lost;
+    sub->_lost = 0;
+    __OS_OWNED_EXIT_CRITICAL
+    return _lost;
+}
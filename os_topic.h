@@ -0,0 +1,78 @@
+/***********************
+ * @file: os_topic.h
+ * @author: Feijie Luo
+ * @Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     Feijie Luo   First version
+ * 2026-10-19     Feijie Luo   Publish from interrupts through os_int_post
+ * 2026-10-19     Feijie Luo   Require a power-of-two capacity
+ * 2026-10-19     Feijie Luo   Widen _slot_size for samples near 64KB
+ * @note:
+ ***********************/
+
+#ifndef _OS_TOPIC_H_
+#define _OS_TOPIC_H_
+
+#include "os_block.h"
+#include "os_config.h"
+#include "os_list.h"
+
+#define OS_TOPIC_NO_WAIT       (0)
+#define OS_TOPIC_NEVER_TIMEOUT (OS_NEVER_TIME_OUT)
+
+// 每个样本槽头部的大小
+#define OS_TOPIC_SLOT_HEAD_SIZE (8)
+// 每个样本槽的大小(4字节对齐)
+#define OS_TOPIC_SLOT_SIZE(msize) \
+    ((OS_TOPIC_SLOT_HEAD_SIZE + (msize) + 3) & ~3)
+// 主题所需的存储空间大小, 用于 os_topic_init_static
+#define OS_TOPIC_POOL_SIZE(mnum, msize) \
+    ((mnum) * OS_TOPIC_SLOT_SIZE(msize))
+
+/*
+ * 发布/订阅主题.
+ * 发布者只将样本写入共享的样本环一次, 每个订阅者按自己的游标读取,
+ * 发布者从不阻塞, 环满时覆盖最旧的样本, 落后超过一圈的订阅者会记录丢失的样本数.
+ */
+struct os_topic {
+    // 样本的最大大小
+    unsigned short _msg_size;
+    // 样本环的容量, 必须为2的幂
+    unsigned short _capacity;
+    // 样本槽大小
+    unsigned int _slot_size;
+    // 存储空间是否由内核堆分配
+    bool _pool_owned;
+    // 下一个发布的样本序号
+    unsigned int _seq;
+    unsigned char *_pool;
+    // 所有订阅者
+    struct list_head _sub_list;
+    // 等待新样本的订阅者
+    struct os_block_object _block_obj;
+};
+
+struct os_topic_sub {
+    struct os_topic *_topic;
+    // 下一个读取的样本序号
+    unsigned int _cursor;
+    // 因落后而丢失的样本数
+    unsigned int _lost;
+    struct list_head _nd;
+};
+
+os_handle_state_t os_topic_init(struct os_topic *topic, unsigned short mnum, unsigned short msize);
+os_handle_state_t os_topic_init_static(struct os_topic *topic,
+                                       void *pool, unsigned int pool_size,
+                                       unsigned short mnum, unsigned short msize);
+os_handle_state_t os_topic_destory(struct os_topic *topic);
+os_handle_state_t os_topic_subscribe(struct os_topic *topic, struct os_topic_sub *sub);
+os_handle_state_t os_topic_unsubscribe(struct os_topic_sub *sub);
+os_handle_state_t os_topic_publish(struct os_topic *topic, const void *buffer, unsigned short msize);
+void __os_int_post_topic_publish(struct os_topic *topic, const void *buffer, unsigned short msize);
+os_handle_state_t os_topic_receive(struct os_topic_sub *sub,
+                                   void *buffer, unsigned short msize,
+                                   unsigned int time_out);
+unsigned int os_topic_sub_lost(struct os_topic_sub *sub);
+
+#endif
@@ -0,0 +1,156 @@
+/***********************
+ * @file: os_wait.c
+ * @author: Feijie Luo
+ * @Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     Feijie Luo   First version
+ * @note:
+ ***********************/
+
+#include "os_block.h"
+#include "os_core.h"
+#include "os_mqueue.h"
+#include "os_sched.h"
+#include "os_semaphore.h"
+#include "os_tick.h"
+#include "os_wait.h"
+
+#include "board/libcpu_headfile.h"
+
+#include "stddef.h"
+
+struct os_wait_ctx {
+    // 等待任务挂载于此
+    struct os_block_object _block_obj;
+    // 第一个就绪对象的下标
+    int _fired;
+};
+
+os_private inline void __os_wait_wakeup_task_cb(struct task_control_block *tcb)
+{
+    // 将该任务从挂载的tick上摘掉
+    list_del_init(&(tcb->_bt_nd));
+}
+
+/*
+ *@func: 获取等待对象对应的阻塞类对象
+ */
+os_private struct os_block_object *__os_wait_obj_block(struct os_wait_obj *wobj)
+{
+    switch (wobj->type) {
+    case OS_WAIT_OBJ_SEM:
+        return &((struct os_sem *)wobj->obj)->_block_obj;
+    case OS_WAIT_OBJ_MQUEUE:
+        return &((struct os_mqueue *)wobj->obj)->_recv_block_obj;
+    default:
+        return NULL;
+    }
+}
+
+/*
+ *@func: 检测等待对象是否就绪
+ */
+os_private bool __os_wait_obj_is_ready(struct os_wait_obj *wobj)
+{
+    switch (wobj->type) {
+    case OS_WAIT_OBJ_SEM:
+        return (OS_HANDLE_SUCCESS == os_sem_try_take((struct os_sem *)wobj->obj));
+    case OS_WAIT_OBJ_MQUEUE:
+        return !os_mqueue_is_empty((struct os_mqueue *)wobj->obj);
+    default:
+        return false;
+    }
+}
+
+/*
+ *@func: 被唤醒后将所有等待节点摘除
+ */
+os_private int __os_wait_finish(struct os_wait_obj *objs,
+                                unsigned int num,
+                                struct os_wait_ctx *ctx,
+                                struct task_control_block *_current_task_tcb)
+{
+    int _ret;
+
+    __OS_OWNED_ENTER_CRITICAL
+    for (unsigned int _i = 0; _i < num; ++_i)
+        list_del_init(&objs[_i]._nd);
+    if (_current_task_tcb->_task_block_state == OS_TASK_BLOCK_TIMEOUT)
+        _ret = OS_WAIT_FAIL;
+    else
+        _ret = ctx->_fired;
+    _current_task_tcb->_task_block_state = OS_TASK_BLOCK_NONE;
+    os_block_deinit(&ctx->_block_obj);
+    __OS_OWNED_EXIT_CRITICAL
+    return _ret;
+}
+
+/*
+ *@func: 同时等待多个内核对象, 返回第一个就绪对象在 objs 中的下标, 超时返回 OS_WAIT_FAIL
+ *@note: 返回值仅表示该对象在唤醒时刻已就绪, 调用者随后需以 NO_WAIT 方式获取该对象
+ *       (如 os_sem_take(sem, OS_SEM_NO_WAIT)), 若被其他任务抢先获取则会失败
+ */
+int os_wait_multiple(struct os_wait_obj *objs, unsigned int num, unsigned int time_out)
+{
+    struct os_wait_ctx _ctx;
+
+    if (NULL == objs || 0 == num)
+        return OS_WAIT_FAIL;
+    for (unsigned int _i = 0; _i < num; ++_i) {
+        if (NULL == objs[_i].obj ||
+            NULL == __os_wait_obj_block(&objs[_i]))
+            return OS_WAIT_FAIL;
+    }
+
+    __OS_OWNED_ENTER_CRITICAL
+
+    for (unsigned int _i = 0; _i < num; ++_i) {
+        if (__os_wait_obj_is_ready(&objs[_i])) {
+            __OS_OWNED_EXIT_CRITICAL
+            return (int)_i;
+        }
+    }
+
+    if (time_out == OS_WAIT_NO_WAIT) {
+        __OS_OWNED_EXIT_CRITICAL
+        return OS_WAIT_FAIL;
+    }
+
+    struct task_control_block *_current_task_tcb = os_get_current_task_tcb();
+    _ctx._fired = OS_WAIT_FAIL;
+    os_block_init(&_ctx._block_obj, OS_BLOCK_WAIT_MULTIPLE);
+    // 通过等待节点挂载到各个对象上
+    for (unsigned int _i = 0; _i < num; ++_i) {
+        objs[_i]._ctx = &_ctx;
+        objs[_i]._index = (int)_i;
+        list_add_tail(&__os_wait_obj_block(&objs[_i])->_wait_list, &objs[_i]._nd);
+    }
+    os_add_tick_task(_current_task_tcb, time_out, &_ctx._block_obj);
+    __OS_OWNED_EXIT_CRITICAL
+    __os_sched();
+
+    // 该处是为了给软中断异常被触发前留足时间
+    while (os_task_is_block(_current_task_tcb)) {
+    };
+
+    return __os_wait_finish(objs, num, &_ctx, _current_task_tcb);
+}
+
+/*
+ *@func: 阻塞类对象就绪时通知在其上等待的任务
+ *@note: 由各内核对象在临界区内调用
+ */
+void os_wait_notify(struct os_block_object *_block_obj)
+{
+    struct list_head *_current_node = NULL;
+    struct os_wait_obj *_wobj = NULL;
+
+    list_for_each(_current_node, &_block_obj->_wait_list)
+    {
+        _wobj = os_list_entry(_current_node, struct os_wait_obj, _nd);
+        if (_wobj->_ctx->_fired == OS_WAIT_FAIL) {
+            _wobj->_ctx->_fired = _wobj->_index;
+            os_block_wakeup_first_task(&_wobj->_ctx->_block_obj, __os_wait_wakeup_task_cb);
+        }
+    }
+}
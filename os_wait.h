@@ -0,0 +1,52 @@
+/***********************
+ * @file: os_wait.h
+ * @author: Feijie Luo
+ * @Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     Feijie Luo   First version
+ * @note:
+ ***********************/
+
+#ifndef _OS_WAIT_H_
+#define _OS_WAIT_H_
+
+#include "os_block.h"
+#include "os_config.h"
+#include "os_list.h"
+
+#define OS_WAIT_NO_WAIT       (0)
+#define OS_WAIT_NEVER_TIMEOUT (OS_NEVER_TIME_OUT)
+#define OS_WAIT_FAIL          (-1)
+
+enum os_wait_obj_type {
+    // 信号量可获取
+    OS_WAIT_OBJ_SEM = 0,
+    // 消息队列非空
+    OS_WAIT_OBJ_MQUEUE = 1,
+};
+
+struct os_wait_ctx;
+
+/*
+ * 等待节点, 由调用者提供(通常位于调用者的栈上).
+ * 一个任务通过多个等待节点同时挂载在多个阻塞类对象上.
+ */
+struct os_wait_obj {
+    enum os_wait_obj_type type;
+    void *obj;
+
+    // 以下成员由内核使用
+    struct list_head _nd;
+    struct os_wait_ctx *_ctx;
+    int _index;
+};
+
+#define OS_WAIT_OBJ_INIT(_type, _obj) \
+    {                                 \
+        .type = (_type), .obj = (_obj) \
+    }
+
+int os_wait_multiple(struct os_wait_obj *objs, unsigned int num, unsigned int time_out);
+void os_wait_notify(struct os_block_object *_block_obj);
+
+#endif
@@ -0,0 +1,367 @@
+/***********************
+ * @file: os_workqueue.c
+ * @author: Feijie Luo
+ * @Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     Feijie Luo   First version
+ * 2026-10-19     Feijie Luo   Never run a work item on two workers, do not touch it after _fn returns.
+ * @note:
+ ***********************/
+
+#include "os_block.h"
+#include "os_core.h"
+#include "os_int_post.h"
+#include "os_sched.h"
+#include "os_soft_timer.h"
+#include "os_tick.h"
+#include "os_workqueue.h"
+
+#include "board/libcpu_headfile.h"
+
+#include "stddef.h"
+
+os_private inline void __os_workqueue_wakeup_task_cb(struct task_control_block *tcb)
+{
+    // 将该任务从挂载的tick上摘掉
+    list_del_init(&(tcb->_bt_nd));
+}
+
+os_private inline unsigned int __os_workqueue_now(void)
+{
+    return os_get_timestamp().c;
+}
+
+os_private inline bool __os_work_is_queued(struct os_work *work)
+{
+    return (work->_state == OS_WORK_PENDING || work->_state == OS_WORK_DELAYED);
+}
+
+/*
+ *@func: 查找正在执行该工作项的工作线程, 在临界区内调用
+ */
+os_private struct os_workqueue_worker *__os_work_runner(struct os_work *work)
+{
+    struct list_head *_pos = NULL;
+
+    if (NULL == work->_wq)
+        return NULL;
+    list_for_each(_pos, &work->_wq->_worker_list)
+    {
+        struct os_workqueue_worker *_worker = os_list_entry(_pos, struct os_workqueue_worker, _nd);
+        if (_worker->_work == work)
+            return _worker;
+    }
+    return NULL;
+}
+
+/*
+ *@func: 唤醒一个空闲的工作线程, 在临界区内调用
+ */
+os_private inline void __os_workqueue_kick(struct os_workqueue *wq)
+{
+    os_block_wakeup_first_task(&wq->_block_obj, __os_workqueue_wakeup_task_cb);
+}
+
+/*
+ *@func: 将工作项加入就绪链表, 在临界区内调用
+ */
+os_private inline void __os_workqueue_enqueue(struct os_workqueue *wq, struct os_work *work)
+{
+    work->_wq = wq;
+    work->_state = OS_WORK_PENDING;
+    list_add_tail(&wq->_pending_list, &work->_nd);
+}
+
+/*
+ *@func: 将工作项按到期时刻加入延时链表, 在临界区内调用
+ */
+os_private void __os_workqueue_enqueue_delayed(struct os_workqueue *wq, struct os_work *work)
+{
+    struct list_head *_pos = NULL;
+
+    work->_wq = wq;
+    work->_state = OS_WORK_DELAYED;
+    // 按到期时刻插入, 相同时刻先进先出
+    list_for_each(_pos, &wq->_delayed_list)
+    {
+        struct os_work *_tmp = os_list_entry(_pos, struct os_work, _nd);
+        if ((int)(work->_deadline - _tmp->_deadline) < 0)
+            break;
+    }
+    list_add_tail(_pos, &work->_nd);
+    // 成为最早到期的工作项时, 唤醒一个空闲的工作线程重新计算超时时间
+    if (wq->_delayed_list.next == &work->_nd)
+        __os_workqueue_kick(wq);
+}
+
+/*
+ *@func: 提交工作项, delay 为 0 时立即就绪, 在临界区内调用
+ *@note: 正在执行的工作项只记录重新提交, 由执行它的工作线程在执行完毕后入队,
+ *       因此同一工作项不会同时在两个工作线程中执行
+ */
+os_private os_handle_state_t __os_work_submit(struct os_workqueue *wq, struct os_work *work,
+                                              unsigned int delay)
+{
+    if (__os_work_is_queued(work))
+        return OS_HANDLE_FAIL;
+
+    struct os_workqueue_worker *_runner = __os_work_runner(work);
+    if (_runner != NULL && _runner->_requeue != OS_WORK_IDLE)
+        return OS_HANDLE_FAIL;
+    // 正在执行时到期时刻同样从现在算起, 执行完毕时已到期则直接就绪
+    if (delay != 0)
+        work->_deadline = __os_workqueue_now() + delay;
+    if (_runner != NULL) {
+        _runner->_requeue = (0 == delay) ? OS_WORK_PENDING : OS_WORK_DELAYED;
+        _runner->_requeue_wq = wq;
+    } else if (delay != 0) {
+        __os_workqueue_enqueue_delayed(wq, work);
+    } else {
+        __os_workqueue_enqueue(wq, work);
+        __os_workqueue_kick(wq);
+    }
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 将到期的延时工作项移入就绪链表, 在临界区内调用
+ */
+os_private void __os_workqueue_promote(struct os_workqueue *wq, unsigned int now)
+{
+    while (!list_empty(&wq->_delayed_list)) {
+        struct os_work *_work = os_list_first_entry(&wq->_delayed_list, struct os_work, _nd);
+        if ((int)(_work->_deadline - now) > 0)
+            break;
+        list_del_init(&_work->_nd);
+        __os_workqueue_enqueue(wq, _work);
+    }
+}
+
+/*
+ *@func: 工作线程空闲时挂起, 直到被唤醒或最早的延时工作项到期
+ */
+os_private void __os_workqueue_sleep(struct task_control_block *_current_task_tcb)
+{
+    __os_sched();
+    // 该处是为了给软中断异常被触发前留足时间
+    while (os_task_is_block(_current_task_tcb)) {
+    };
+
+    __OS_OWNED_ENTER_CRITICAL
+    _current_task_tcb->_task_block_state = OS_TASK_BLOCK_NONE;
+    __OS_OWNED_EXIT_CRITICAL
+}
+
+/*
+ *@func: 取出下一个要执行的工作项, 没有时阻塞
+ */
+os_private struct os_work *__os_workqueue_next(struct os_workqueue *wq,
+                                               struct os_workqueue_worker *_worker,
+                                               struct task_control_block *_current_task_tcb)
+{
+    for (;;) {
+        __OS_OWNED_ENTER_CRITICAL
+
+        unsigned int _now = __os_workqueue_now();
+        __os_workqueue_promote(wq, _now);
+        if (!list_empty(&wq->_pending_list)) {
+            struct os_work *_work = os_list_first_entry(&wq->_pending_list, struct os_work, _nd);
+            list_del_init(&_work->_nd);
+            _work->_state = OS_WORK_IDLE;
+            _worker->_work = _work;
+            _worker->_requeue = OS_WORK_IDLE;
+            __OS_OWNED_EXIT_CRITICAL
+            return _work;
+        }
+
+        // 以最早到期的延时工作项作为超时时间
+        unsigned int _time_out = OS_NEVER_TIME_OUT;
+        if (!list_empty(&wq->_delayed_list))
+            _time_out = os_list_first_entry(&wq->_delayed_list, struct os_work, _nd)->_deadline - _now;
+        os_add_tick_task(_current_task_tcb, _time_out, &wq->_block_obj);
+        __OS_OWNED_EXIT_CRITICAL
+
+        __os_workqueue_sleep(_current_task_tcb);
+    }
+}
+
+/*
+ *@func: 工作项执行完毕, 执行期间被重新提交时由本工作线程入队
+ *@note: 没有被重新提交时不再访问工作项, _fn 可能已经释放了它
+ */
+os_private void __os_workqueue_done(struct os_workqueue_worker *_worker)
+{
+    __OS_OWNED_ENTER_CRITICAL
+    struct os_work *_work = _worker->_work;
+    enum os_work_state _requeue = _worker->_requeue;
+
+    _worker->_work = NULL;
+    _worker->_requeue = OS_WORK_IDLE;
+    if (OS_WORK_DELAYED == _requeue) {
+        __os_workqueue_enqueue_delayed(_worker->_requeue_wq, _work);
+    } else if (OS_WORK_PENDING == _requeue) {
+        __os_workqueue_enqueue(_worker->_requeue_wq, _work);
+        __os_workqueue_kick(_worker->_requeue_wq);
+    }
+    __OS_OWNED_EXIT_CRITICAL
+    if (_requeue != OS_WORK_IDLE)
+        __os_sched();
+}
+
+os_private void __os_workqueue_worker(void *_arg)
+{
+    struct os_workqueue *_wq = (struct os_workqueue *)_arg;
+    struct task_control_block *_current_task_tcb = os_get_current_task_tcb();
+    struct os_workqueue_worker _worker;
+    struct os_work *_work;
+
+    _worker._work = NULL;
+    _worker._requeue = OS_WORK_IDLE;
+    _worker._requeue_wq = NULL;
+    __OS_OWNED_ENTER_CRITICAL
+    list_add_tail(&_wq->_worker_list, &_worker._nd);
+    __OS_OWNED_EXIT_CRITICAL
+
+    while (1) {
+        _work = __os_workqueue_next(_wq, &_worker, _current_task_tcb);
+        _work->_fn(_work);
+        __os_workqueue_done(&_worker);
+    }
+}
+
+/*
+ *@func: 由软中断处理 os_int_post 时调用, 提交中断中的工作项
+ */
+os_private void __os_workqueue_isr_submit(void *_arg)
+{
+    struct os_work *_work = (struct os_work *)_arg;
+
+    __os_work_submit(_work->_isr_wq, _work, 0);
+}
+
+/*
+ *@func: 初始化工作队列, 随后通过 os_workqueue_add_worker 添加工作线程
+ */
+os_handle_state_t os_workqueue_init(struct os_workqueue *wq)
+{
+    if (NULL == wq)
+        return OS_HANDLE_FAIL;
+    list_head_init(&wq->_pending_list);
+    list_head_init(&wq->_delayed_list);
+    list_head_init(&wq->_worker_list);
+    os_block_init(&wq->_block_obj, OS_BLOCK_WORKQUEUE);
+    return OS_HANDLE_SUCCESS;
+}
+
+/*
+ *@func: 为工作队列创建一个工作线程, 线程控制块与栈由调用者提供
+ *@note: 同一工作队列的多个工作线程可以使用不同的优先级
+ */
+os_handle_state_t os_workqueue_add_worker(struct os_workqueue *wq,
+                                          struct task_control_block *tcb,
+                                          unsigned int *stack, unsigned int stack_size,
+                                          unsigned char prio, const char *name)
+{
+    if (NULL == wq ||
+        NULL == tcb ||
+        NULL == stack)
+        return OS_HANDLE_FAIL;
+    return os_task_create(tcb, stack, stack_size, prio, __os_workqueue_worker, (void *)wq, name);
+}
+
+void os_work_init(struct os_work *work, os_work_fn fn, void *arg)
+{
+    if (NULL == work)
+        return;
+    work->_fn = fn;
+    work->_arg = arg;
+    work->_state = OS_WORK_IDLE;
+    work->_deadline = 0;
+    work->_wq = NULL;
+    work->_isr_wq = NULL;
+    list_head_init(&work->_nd);
+}
+
+inline void *os_work_get_arg(struct os_work *work)
+{
+    return work->_arg;
+}
+
+/*
+ *@func: 提交工作项, 已在等待执行时返回 OS_HANDLE_FAIL
+ *@note: 正在执行的工作项可以被重新提交一次, 执行完毕后由执行它的工作线程入队并再次执行
+ */
+os_handle_state_t os_work_submit(struct os_workqueue *wq, struct os_work *work)
+{
+    if (NULL == wq ||
+        NULL == work ||
+        NULL == work->_fn)
+        return OS_HANDLE_FAIL;
+
+    __OS_OWNED_ENTER_CRITICAL
+    os_handle_state_t _ret = __os_work_submit(wq, work, 0);
+    __OS_OWNED_EXIT_CRITICAL
+    if (OS_HANDLE_SUCCESS == _ret)
+        __os_sched();
+    return _ret;
+}
+
+/*
+ *@func: 提交延时工作项, delay 个tick后执行
+ */
+os_handle_state_t os_work_submit_delayed(struct os_workqueue *wq, struct os_work *work, unsigned int delay)
+{
+    if (0 == delay)
+        return os_work_submit(wq, work);
+    if (NULL == wq ||
+        NULL == work ||
+        NULL == work->_fn)
+        return OS_HANDLE_FAIL;
+
+    __OS_OWNED_ENTER_CRITICAL
+    os_handle_state_t _ret = __os_work_submit(wq, work, delay);
+    __OS_OWNED_EXIT_CRITICAL
+    if (OS_HANDLE_SUCCESS == _ret)
+        __os_sched();
+    return _ret;
+}
+
+/*
+ *@func: 在中断中提交工作项, 实际的入队被推迟到软中断中进行
+ */
+os_handle_state_t os_work_submit_from_isr(struct os_workqueue *wq, struct os_work *work)
+{
+    if (NULL == wq ||
+        NULL == work ||
+        NULL == work->_fn ||
+        __os_work_is_queued(work))
+        return OS_HANDLE_FAIL;
+    work->_isr_wq = wq;
+    return os_int_post_call(__os_workqueue_isr_submit, work);
+}
+
+/*
+ *@func: 取消尚未执行的工作项, 包括执行期间的重新提交, 没有等待执行时返回 OS_HANDLE_FAIL
+ *@note: 正在进行的执行不会被打断
+ */
+os_handle_state_t os_work_cancel(struct os_work *work)
+{
+    if (NULL == work)
+        return OS_HANDLE_FAIL;
+    __OS_OWNED_ENTER_CRITICAL
+    if (__os_work_is_queued(work)) {
+        list_del_init(&work->_nd);
+        work->_state = OS_WORK_IDLE;
+        __OS_OWNED_EXIT_CRITICAL
+        return OS_HANDLE_SUCCESS;
+    }
+
+    struct os_workqueue_worker *_runner = __os_work_runner(work);
+    if (NULL == _runner || OS_WORK_IDLE == _runner->_requeue) {
+        __OS_OWNED_EXIT_CRITICAL
+        return OS_HANDLE_FAIL;
+    }
+    _runner->_requeue = OS_WORK_IDLE;
+    __OS_OWNED_EXIT_CRITICAL
+    return OS_HANDLE_SUCCESS;
+}
@@ -0,0 +1,85 @@
+/***********************
+ * @file: os_workqueue.h
+ * @author: Feijie Luo
+ * @Change Logs:
+ * Date           Author       Notes
+ * 2026-10-19     Feijie Luo   First version
+ * 2026-10-19     Feijie Luo   Track running work items in their worker, requeue them when done.
+ * @note:
+ ***********************/
+
+#ifndef _OS_WORKQUEUE_H_
+#define _OS_WORKQUEUE_H_
+
+#include "os_block.h"
+#include "os_config.h"
+#include "os_core.h"
+#include "os_list.h"
+
+enum os_work_state {
+    OS_WORK_IDLE = 0,
+    // 在就绪链表中等待执行
+    OS_WORK_PENDING,
+    // 在延时链表中等待到期
+    OS_WORK_DELAYED,
+};
+
+struct os_work;
+typedef void (*os_work_fn)(struct os_work *work);
+
+/*
+ * 工作项, 由调用者静态分配.
+ * 工作项处于等待状态时只能提交到同一个工作队列.
+ * 正在执行的工作项由执行它的工作线程记录, 工作项本身处于 OS_WORK_IDLE,
+ * 因此 _fn 可以释放自己的工作项, 只要之后不再提交它.
+ */
+struct os_work {
+    os_work_fn _fn;
+    void *_arg;
+    enum os_work_state _state;
+    // 延时工作项的到期时刻(jiffies)
+    unsigned int _deadline;
+    struct os_workqueue *_wq;
+    // 中断中提交的目标工作队列, 在软中断中入队时使用
+    struct os_workqueue *_isr_wq;
+    struct list_head _nd;
+};
+
+/*
+ * 工作线程, 记录正在执行的工作项以及执行期间的重新提交.
+ */
+struct os_workqueue_worker {
+    struct os_work *_work;
+    // 执行完毕后进入的状态, OS_WORK_IDLE 表示没有被重新提交
+    enum os_work_state _requeue;
+    struct os_workqueue *_requeue_wq;
+    struct list_head _nd;
+};
+
+/*
+ * 工作队列, 由一个或多个工作线程执行提交的工作项.
+ */
+struct os_workqueue {
+    // 就绪的工作项, 先进先出
+    struct list_head _pending_list;
+    // 延时的工作项, 按到期时刻排序
+    struct list_head _delayed_list;
+    // 空闲的工作线程
+    struct os_block_object _block_obj;
+    // 所有工作线程, 见 struct os_workqueue_worker
+    struct list_head _worker_list;
+};
+
+os_handle_state_t os_workqueue_init(struct os_workqueue *wq);
+os_handle_state_t os_workqueue_add_worker(struct os_workqueue *wq,
+                                          struct task_control_block *tcb,
+                                          unsigned int *stack, unsigned int stack_size,
+                                          unsigned char prio, const char *name);
+void os_work_init(struct os_work *work, os_work_fn fn, void *arg);
+void *os_work_get_arg(struct os_work *work);
+os_handle_state_t os_work_submit(struct os_workqueue *wq, struct os_work *work);
+os_handle_state_t os_work_submit_delayed(struct os_workqueue *wq, struct os_work *work, unsigned int delay);
+os_handle_state_t os_work_submit_from_isr(struct os_workqueue *wq, struct os_work *work);
+os_handle_state_t os_work_cancel(struct os_work *work);
+
+#endif